@@ -0,0 +1,121 @@
+# Nim futures for c++ asynchronous operations. Bindings with `_async` wrappers import this.
+#
+# Completion callbacks may run on any c++ thread. They only store their result and push the
+# operation onto a lock-free queue; the future is completed when the dispatcher drains it.
+# `std::future` cannot notify anyone, so those are polled from a dispatcher timer instead.
+
+import std/asyncdispatch
+import runtime
+export asyncdispatch
+
+const hpp = "ensnare/private/async.hpp"
+
+type
+   CppCompletion {.import_cpp: "ensnare::runtime::Completion", header: hpp.} = object
+      next: ptr CppCompletion
+      resume: proc (self: ptr CppCompletion) {.cdecl.}
+   CppOperation*[T] = object
+      ## A callback operation in flight. The completion comes first, its address is what c++
+      ## queues.
+      completion: CppCompletion
+      future: Future[T]
+      when T isnot void:
+         value: T
+   CppFutureOperation*[F; T] = ref object
+      ## A `std::future` of type `F` in flight.
+      held: Cpp[F]
+      future: Future[T]
+
+proc queue_push(completion: ptr CppCompletion)
+   {.import_cpp: "ensnare::runtime::completion_queue().push(#)", header: hpp.}
+proc queue_drain() {.import_cpp: "ensnare::runtime::completion_queue().drain()", header: hpp.}
+proc queue_fd(): cint
+   {.import_cpp: "ensnare::runtime::completion_queue().event_fd()", header: hpp.}
+
+var registered {.threadvar.}: bool
+
+proc register_queue =
+   ## Drain the completion queue from this thread's dispatcher.
+   if not registered:
+      registered = true
+      let fd = queue_fd()
+      if fd != -1:
+         register(AsyncFD(fd))
+         add_read(AsyncFD(fd), proc (fd: AsyncFD): bool =
+            queue_drain()
+            false)
+      else:
+         add_timer(1, false, proc (fd: AsyncFD): bool =
+            queue_drain()
+            false)
+
+proc resume[T](completion: ptr CppCompletion) {.cdecl.} =
+   let op = cast[ptr CppOperation[T]](completion)
+   let future = move(op.future)
+   when T is void:
+      reset(op[])
+      dealloc(op)
+      future.complete()
+   else:
+      let value = move(op.value)
+      reset(op[])
+      dealloc(op)
+      future.complete(value)
+
+proc cpp_operation*(T: typedesc): ptr CppOperation[T] =
+   ## Start an operation. It is the context passed to the completion callback and is freed when
+   ## its future completes.
+   register_queue()
+   result = create(CppOperation[T])
+   result.completion.resume = resume[T]
+   result.future = new_future[T]("cpp_operation")
+
+proc cpp_future*[T](op: ptr CppOperation[T]): Future[T] = op.future
+
+proc cpp_complete*[T](op: ptr CppOperation[T], value: T) =
+   ## Finish `op` from a completion callback, on any thread. `value` must not hold nim references.
+   op.value = value
+   queue_push(addr op.completion)
+
+proc cpp_complete*(op: ptr CppOperation[void]) =
+   queue_push(addr op.completion)
+
+proc is_ready[F](held: var Cpp[F]): bool
+   {.import_cpp: "ensnare::runtime::is_ready(#.detail.unsafe_deref())", header: hpp.}
+proc get[F; T](held: var Cpp[F], _: type[T]): T {.import_cpp: "#.detail.unsafe_deref().get()".}
+proc get_void[F](held: var Cpp[F]) {.import_cpp: "#.detail.unsafe_deref().get()".}
+
+var pending {.threadvar.}: seq[proc (): bool]
+var polling {.threadvar.}: bool
+
+proc poll_pending(fd: AsyncFD): bool =
+   var i = 0
+   while i < pending.len:
+      if pending[i]():
+         pending.del(i)
+      else:
+         i += 1
+   polling = pending.len != 0
+   not polling
+
+proc cpp_future_operation*(F, T: typedesc): CppFutureOperation[F, T] =
+   CppFutureOperation[F, T](future: new_future[T]("cpp_future_operation"))
+
+proc cpp_held*[F; T](op: CppFutureOperation[F, T]): var Cpp[F] = op.held
+   ## Where the `std::future` is constructed.
+
+proc cpp_poll*[F; T](op: CppFutureOperation[F, T]): Future[T] =
+   ## Complete the future of `op` once its `std::future` is ready. It is checked every
+   ## millisecond, without blocking.
+   result = op.future
+   pending.add(proc (): bool =
+      result = is_ready(op.held)
+      if result:
+         when T is void:
+            get_void(op.held)
+            op.future.complete()
+         else:
+            op.future.complete(get(op.held, T)))
+   if not polling:
+      polling = true
+      add_timer(1, false, poll_pending)
@@ -0,0 +1,99 @@
+/// \file
+/// Completion of c++ asynchronous operations on the nim thread that runs the async dispatcher.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
+
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+namespace ensnare::runtime {
+/// An operation that finished on some c++ thread and waits for nim to resume it. Nim embeds it at
+/// the start of its own operation object, so queueing it does not allocate.
+struct Completion {
+   Completion* next;
+   void (*resume)(Completion*);
+};
+
+/// Completions pushed from any thread and drained by the nim dispatcher thread. Pushing is
+/// lock-free. On linux the first push after a drain wakes the dispatcher through an eventfd.
+class CompletionQueue {
+   std::atomic<Completion*> head{nullptr};
+   int fd = -1;
+
+   public:
+   CompletionQueue() {
+#if defined(__linux__)
+      this->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+   }
+
+   CompletionQueue(const CompletionQueue&) = delete;
+
+   ~CompletionQueue() {
+#if defined(__linux__)
+      if (this->fd != -1) {
+         close(this->fd);
+      }
+#endif
+   }
+
+   /// Readable once there is something to drain, or `-1` if the dispatcher has to poll.
+   int event_fd() const { return this->fd; }
+
+   void push(Completion* completion) {
+      auto old = this->head.load(std::memory_order_relaxed);
+      do {
+         completion->next = old;
+      } while (!this->head.compare_exchange_weak(old, completion, std::memory_order_release,
+                                                 std::memory_order_relaxed));
+#if defined(__linux__)
+      // A non-empty queue has already signalled and not been drained yet.
+      if (old == nullptr && this->fd != -1) {
+         std::uint64_t one = 1;
+         (void)!write(this->fd, &one, sizeof(one));
+      }
+#endif
+   }
+
+   /// Resume everything pushed so far, in the order it was pushed.
+   void drain() {
+#if defined(__linux__)
+      if (this->fd != -1) {
+         std::uint64_t count;
+         (void)!read(this->fd, &count, sizeof(count));
+      }
+#endif
+      auto pushed = this->head.exchange(nullptr, std::memory_order_acquire);
+      Completion* ordered = nullptr;
+      while (pushed) {
+         auto next = pushed->next;
+         pushed->next = ordered;
+         ordered = pushed;
+         pushed = next;
+      }
+      while (ordered) {
+         auto next = ordered->next;
+         ordered->resume(ordered);
+         ordered = next;
+      }
+   }
+};
+
+/// The queue of the process. It is drained by the thread that registered it with its dispatcher.
+inline CompletionQueue& completion_queue() {
+   static CompletionQueue queue;
+   return queue;
+}
+
+/// Does `future` hold a result yet. Never blocks.
+template <typename T> bool is_ready(const std::future<T>& future) {
+   return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+} // namespace ensnare::runtime
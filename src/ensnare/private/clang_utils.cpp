@@ -111,3 +111,56 @@ OptRef<const clang::TagDecl> ensnare::inner_tag(const clang::TypedefDecl& decl)
    }
    return {};
 }
+
+bool ensnare::has_layout(const clang::RecordDecl& decl) {
+   return decl.isCompleteDefinition() && !decl.isDependentType() && !decl.isInvalidDecl();
+}
+
+bool ensnare::is_nothrow(const clang::FunctionDecl& decl) {
+   if (decl.isTrivial() || decl.hasAttr<clang::NoThrowAttr>()) {
+      return true;
+   } else if (auto proto = decl.getType()->getAs<clang::FunctionProtoType>()) {
+      return !clang::isUnresolvedExceptionSpec(proto->getExceptionSpecType()) &&
+             proto->isNothrow();
+   } else {
+      return false;
+   }
+}
+
+static bool usable(const clang::CXXMethodDecl& decl) {
+   return !decl.isDeleted() && decl.getAccess() == clang::AS_public;
+}
+
+bool ensnare::has_copy_ctor(const clang::CXXRecordDecl& decl) {
+   if (decl.needsImplicitCopyConstructor()) {
+      return !decl.defaultedCopyConstructorIsDeleted();
+   } else {
+      for (auto ctor : decl.ctors()) {
+         if (ctor->isCopyConstructor() && usable(*ctor)) {
+            return true;
+         }
+      }
+      return false;
+   }
+}
+
+bool ensnare::has_move_ctor(const clang::CXXRecordDecl& decl) {
+   if (decl.needsImplicitMoveConstructor()) {
+      return !decl.defaultedMoveConstructorIsDeleted();
+   } else {
+      for (auto ctor : decl.ctors()) {
+         if (ctor->isMoveConstructor() && usable(*ctor)) {
+            return true;
+         }
+      }
+      return false;
+   }
+}
+
+bool ensnare::has_dtor(const clang::CXXRecordDecl& decl) {
+   if (auto dtor = decl.getDestructor()) {
+      return usable(*dtor);
+   } else {
+      return !decl.defaultedDestructorIsDeleted();
+   }
+}
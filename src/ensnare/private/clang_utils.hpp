@@ -2,6 +2,7 @@
 
 #include "ensnare/private/utils.hpp"
 
+#include "clang/AST/RecordLayout.h"
 #include "clang/AST/RecursiveASTVisitor.h"
 #include "clang/Tooling/Tooling.h"
 #include "llvm/Support/raw_ostream.h"
@@ -67,6 +68,22 @@ Str qual_name(const clang::NamedDecl* decl);
 
 OptRef<const clang::TagDecl> inner_tag(const clang::TypedefDecl& decl);
 
+/// Can clang compute a layout for this record. It must be complete and not dependent.
+bool has_layout(const clang::RecordDecl& decl);
+
+/// Is the function guaranteed to not throw. Specifications clang has not evaluated yet count as
+/// throwing, except for trivial special members which never throw.
+bool is_nothrow(const clang::FunctionDecl& decl);
+
+/// Does the class have a public, non-deleted copy constructor, declared or implicit.
+bool has_copy_ctor(const clang::CXXRecordDecl& decl);
+
+/// Does the class have a public, non-deleted move constructor, declared or implicit.
+bool has_move_ctor(const clang::CXXRecordDecl& decl);
+
+/// Does the class have a public, non-deleted destructor, declared or implicit.
+bool has_dtor(const clang::CXXRecordDecl& decl);
+
 template <typename T> using DeclVisitor = void (*)(T&, const clang::Decl&);
 
 template <typename T>
@@ -6,12 +6,20 @@ namespace cl = llvm::cl;
 using namespace ensnare;
 cl::list<Str> syms("sym", cl::desc("specify specific symbols to bind. FIXME: not implimented"));
 cl::list<Str> gensym_types("gensym-type", cl::desc("mangle a type symbol"));
+cl::list<Str> instantiate("instantiate",
+                          cl::desc("compile a class template instantiation only once"));
 cl::list<Str> include_dirs("include-dir", cl::desc("allow binding any headers in this directory"));
 cl::opt<bool> fold_type_suffix("fold-type-suffix",
                                cl::desc("fold the inner type of a typedef with _t suffix"));
 cl::opt<bool> disable_includes("disable-includes",
                                cl::desc("do not gather system includes. FIXME: not implimented"));
 cl::opt<bool> ignore_const("ignore-const", cl::desc("ignore const qualifiers"));
+cl::opt<bool> discardable("discardable",
+                          cl::desc("make results of routines that are not nodiscard discardable"));
+cl::opt<bool> shims("shims",
+                    cl::desc("call functions and methods through extern \"C\" thunks compiled once"));
+cl::opt<bool> umbrella("umbrella", cl::desc("import everything from one generated header"));
+cl::opt<bool> pch("pch", cl::desc("precompile the generated header for the nim backend"));
 cl::opt<Str> output(cl::Positional, cl::desc("output wrapper name/path"));
 cl::list<Str> args(cl::ConsumeAfter, cl::desc("clang args..."));
 
@@ -20,19 +28,29 @@ const Path& ensnare::Config::output() const { return _output; }
 const Vec<Str>& ensnare::Config::user_clang_args() const { return _user_clang_args; }
 const Vec<Str>& ensnare::Config::syms() const { return _syms; }
 const Vec<Str>& ensnare::Config::gensym_types() const { return _gensym_types; }
+const Vec<Str>& ensnare::Config::instantiations() const { return _instantiations; }
 const Vec<Str>& ensnare::Config::include_dirs() const { return _include_dirs; }
 bool ensnare::Config::disable_includes() const { return _disable_includes; }
 bool ensnare::Config::fold_type_suffix() const { return _fold_type_suffix; }
 bool ensnare::Config::ignore_const() const { return _ignore_const; }
+bool ensnare::Config::discardable() const { return _discardable; }
+bool ensnare::Config::shims() const { return _shims; }
+bool ensnare::Config::umbrella() const { return _umbrella || _pch || _instantiations.size() != 0; }
+bool ensnare::Config::pch() const { return _pch; }
 
 ensnare::Config::Config(int argc, const char* argv[]) {
    llvm::cl::ParseCommandLineOptions(argc, argv);
    _syms = ::syms;
    _gensym_types = ::gensym_types;
+   _instantiations = ::instantiate;
    _include_dirs = ::include_dirs;
    _fold_type_suffix = ::fold_type_suffix;
    _disable_includes = ::disable_includes;
    _ignore_const = ::ignore_const;
+   _discardable = ::discardable;
+   _shims = ::shims;
+   _umbrella = ::umbrella;
+   _pch = ::pch;
    _output = Str(::output);
    for (const auto& arg : args) {
       auto header = Header::parse(arg);
@@ -56,6 +74,12 @@ Str ensnare::Config::header_file() const {
    };
 }
 
+Str ensnare::Config::umbrella_header() const { return _output.stem().string() + "_headers.hpp"; }
+
+Str ensnare::Config::instances_source() const { return _output.stem().string() + "_instances.cpp"; }
+
+Str ensnare::Config::shims_source() const { return _output.stem().string() + "_shims.cpp"; }
+
 void ensnare::Config::dump() const {
    print("Config:");
    print("   output: ", _output);
@@ -68,4 +92,7 @@ void ensnare::Config::dump() const {
    for (const auto& sym : _syms) {
       print("   sym: ", sym);
    }
+   for (const auto& instantiation : _instantiations) {
+      print("   instantiate: ", instantiation);
+   }
 }
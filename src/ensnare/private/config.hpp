@@ -17,9 +17,14 @@ class Config {
    Vec<Str> _include_dirs;
    Vec<Str> _syms;
    Vec<Str> _gensym_types;
+   Vec<Str> _instantiations;
    bool _disable_includes;
    bool _fold_type_suffix;
    bool _ignore_const;
+   bool _discardable;
+   bool _shims;
+   bool _umbrella;
+   bool _pch;
 
    public:
    /// The output location.
@@ -35,14 +40,34 @@ class Config {
    /// Specifies specific symbols to bind instead of trying to be smart.
    const Vec<Str>& syms() const;
    const Vec<Str>& gensym_types() const;
+   /// Class template instantiations, like `std::vector<int>`, compiled once in a companion
+   /// translation unit instead of in every nim module that uses them.
+   const Vec<Str>& instantiations() const;
    /// If we should try to find some reasonable include search paths from a compiler.
    bool disable_includes() const;
    bool fold_type_suffix() const;
    bool ignore_const() const;
+   /// If the results of routines not declared `[[nodiscard]]` can be implicitly discarded.
+   bool discardable() const;
+   /// If non-template functions, methods and constructors of builtin types and plain structs are
+   /// called through `extern "C"` thunks, and those structs are bound as plain nim objects, so
+   /// that only one translation unit includes the bound headers for them.
+   bool shims() const;
    /// Make a Config from unparsed command line parameters.
    Config(int argc, const char* argv[]);
    /// A header file with all the headers"()" rendered together.
    Str header_file() const;
+   /// If the bindings import everything from one generated header, see umbrella_header.
+   /// Precompiling it or requesting instantiations implies this.
+   bool umbrella() const;
+   /// If the umbrella header is precompiled for the nim backend.
+   bool pch() const;
+   /// The header that includes the bound headers and declares each instantiation `extern`.
+   Str umbrella_header() const;
+   /// The source file that defines each instantiation.
+   Str instances_source() const;
+   /// The source file of the `extern "C"` thunks.
+   Str shims_source() const;
    /// Dump the config to stdout.
    void dump() const;
 };
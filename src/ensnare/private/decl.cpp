@@ -8,14 +8,29 @@ ensnare::EnumFieldDecl::EnumFieldDecl(Sym name) : name(name) {}
 
 ensnare::EnumFieldDecl::EnumFieldDecl(Sym name, I64 val) : name(name), val(val) {}
 
-ensnare::EnumTypeDecl::EnumTypeDecl(Sym name, Str cpp_name, Str header, Vec<EnumFieldDecl> fields)
-   : name(name), cpp_name(cpp_name), header(header), fields(fields) {}
+ensnare::EnumTypeDecl::EnumTypeDecl(Sym name, Str cpp_name, Str header, Vec<EnumFieldDecl> fields,
+                                    Opt<U64> size, bool flags)
+   : name(name), cpp_name(cpp_name), header(header), fields(fields), size(size), flags(flags) {}
 
 ensnare::RecordFieldDecl::RecordFieldDecl(Str name, Type type) : name(new_Sym(name)), type(type) {}
 
+ensnare::RecordFieldDecl::RecordFieldDecl(Str name, Type type, U64 offset, Opt<U64> align)
+   : name(new_Sym(name)), type(type), offset(offset), align(align) {}
+
+ensnare::RecordLayout::RecordLayout(U64 size, U64 align, bool complete, bool packed,
+                                    U64 pointer_size)
+   : size(size), align(align), complete(complete), packed(packed), pointer_size(pointer_size) {}
+
 ensnare::RecordTypeDecl::RecordTypeDecl(Sym name, Str cpp_name, Str header,
-                                        Vec<RecordFieldDecl> fields)
-   : name(name), cpp_name(cpp_name), header(header), fields(fields) {}
+                                        Vec<RecordFieldDecl> fields, bool trivially_copyable,
+                                        Opt<RecordLayout> layout, bool plain)
+   : name(name),
+     cpp_name(cpp_name),
+     header(header),
+     fields(fields),
+     trivially_copyable(trivially_copyable),
+     layout(layout),
+     plain(plain) {}
 
 ensnare::RecordTypeDecl::RecordTypeDecl(Sym name, Str cpp_name, Str header,
                                         TemplateParams template_params, Vec<RecordFieldDecl> fields)
@@ -23,7 +38,9 @@ ensnare::RecordTypeDecl::RecordTypeDecl(Sym name, Str cpp_name, Str header,
      cpp_name(cpp_name),
      header(header),
      template_params(template_params),
-     fields(fields) {}
+     fields(fields),
+     trivially_copyable(false),
+     plain(false) {}
 
 SymObj& ensnare::name(TypeDecl decl) {
    if (is<AliasTypeDecl>(decl)) {
@@ -58,46 +75,71 @@ Type ensnare::Param::type() const { return _type; }
 
 Opt<Expr> ensnare::Param::expr() const { return _expr; }
 
+ensnare::RoutineAttrs::RoutineAttrs(bool nothrow, bool no_side_effect, bool discardable)
+   : nothrow(nothrow), no_side_effect(no_side_effect), discardable(discardable) {}
+
 ensnare::FunctionDecl::FunctionDecl(Str name, Str cpp_name, Str header, Params params,
-                                    Opt<Type> return_type)
+                                    Opt<Type> return_type, RoutineAttrs attrs)
    : name(new_Sym(name)),
      cpp_name(cpp_name),
      header(header),
      params(params),
-     return_type(return_type) {}
+     return_type(return_type),
+     attrs(attrs) {}
 
 ensnare::FunctionDecl::FunctionDecl(Str name, Str cpp_name, Str header,
                                     TemplateParams template_params, Params params,
-                                    Opt<Type> return_type)
+                                    Opt<Type> return_type, RoutineAttrs attrs)
    : name(new_Sym(name)),
      cpp_name(cpp_name),
      header(header),
      template_params(template_params),
      params(params),
-     return_type(return_type) {}
+     return_type(return_type),
+     attrs(attrs) {}
+
+ensnare::ShimDecl::ShimDecl(Str name, Str symbol, Params params, Opt<Type> return_type,
+                            RoutineAttrs attrs)
+   : name(new_Sym(name)),
+     symbol(symbol),
+     params(params),
+     return_type(return_type),
+     attrs(attrs) {}
+
+ensnare::ShimDecl::ShimDecl(Str name, Str symbol, Type self, Params params, Opt<Type> return_type,
+                            RoutineAttrs attrs)
+   : name(new_Sym(name)),
+     symbol(symbol),
+     self(self),
+     params(params),
+     return_type(return_type),
+     attrs(attrs) {}
 
 ensnare::ConstructorDecl::ConstructorDecl(Str cpp_name, Str header,
                                           Opt<TemplateParams> self_template_params, Type self,
-                                          Params params)
+                                          Params params, RoutineAttrs attrs)
    : cpp_name(cpp_name),
      header(header),
      self_template_params(self_template_params),
      self(self),
-     params(params) {}
+     params(params),
+     attrs(attrs) {}
 
 ensnare::ConstructorDecl::ConstructorDecl(Str cpp_name, Str header,
                                           Opt<TemplateParams> self_template_params, Type self,
-                                          TemplateParams template_params, Params params)
+                                          TemplateParams template_params, Params params,
+                                          RoutineAttrs attrs)
    : cpp_name(cpp_name),
      header(header),
      self_template_params(self_template_params),
      self(self),
      template_params(template_params),
-     params(params) {}
+     params(params),
+     attrs(attrs) {}
 
 ensnare::MethodDecl::MethodDecl(Str name, Str cpp_name, Str header,
                                 Opt<TemplateParams> self_template_params, Type self, Params params,
-                                Opt<Type> return_type, bool is_static)
+                                Opt<Type> return_type, bool is_static, RoutineAttrs attrs)
    : name(new_Sym(name)),
      cpp_name(cpp_name),
      header(header),
@@ -105,12 +147,13 @@ ensnare::MethodDecl::MethodDecl(Str name, Str cpp_name, Str header,
      self(self),
      params(params),
      return_type(return_type),
-     is_static(is_static) {}
+     is_static(is_static),
+     attrs(attrs) {}
 
 ensnare::MethodDecl::MethodDecl(Str name, Str cpp_name, Str header,
                                 Opt<TemplateParams> self_template_params, Type self,
                                 TemplateParams template_params, Params params,
-                                Opt<Type> return_type, bool is_static)
+                                Opt<Type> return_type, bool is_static, RoutineAttrs attrs)
    : name(new_Sym(name)),
      cpp_name(cpp_name),
      header(header),
@@ -119,7 +162,78 @@ ensnare::MethodDecl::MethodDecl(Str name, Str cpp_name, Str header,
      template_params(template_params),
      params(params),
      return_type(return_type),
+     is_static(is_static),
+     attrs(attrs) {}
+
+ensnare::HooksDecl::HooksDecl(Str cpp_name, Str header, Type self, bool destructible,
+                              bool copyable, bool movable)
+   : cpp_name(cpp_name),
+     header(header),
+     self(self),
+     destructible(destructible),
+     copyable(copyable),
+     movable(movable) {}
+
+ensnare::ViewDecl::ViewDecl(Str header, Opt<TemplateParams> self_template_params, Type self,
+                            Type element, bool from_open_array)
+   : header(header),
+     self_template_params(self_template_params),
+     self(self),
+     element(element),
+     from_open_array(from_open_array) {}
+
+ensnare::IteratorDecl::IteratorDecl(Opt<TemplateParams> self_template_params, Type self,
+                                    Type iterator, Type element, bool by_ref,
+                                    bool mutable_elements)
+   : self_template_params(self_template_params),
+     self(self),
+     iterator(iterator),
+     element(element),
+     by_ref(by_ref),
+     mutable_elements(mutable_elements) {}
+
+ensnare::TrampolineDecl::TrampolineDecl(Sym name, Params params, Opt<Type> return_type,
+                                        Size callback, Opt<Size> context, Type signature,
+                                        Size slot, Opt<Type> function,
+                                        Opt<TemplateParams> self_template_params,
+                                        Opt<Type> self, bool is_static)
+   : name(name),
+     params(params),
+     return_type(return_type),
+     callback(callback),
+     context(context),
+     signature(signature),
+     slot(slot),
+     function(function),
+     self_template_params(self_template_params),
+     self(self),
      is_static(is_static) {}
 
+ensnare::AsyncDecl::AsyncDecl(Sym name, Str cpp_name, Str header, Params params,
+                              Opt<Type> value, Size callback, Size context, Size slot)
+   : name(name),
+     cpp_name(cpp_name),
+     header(header),
+     params(params),
+     value(value),
+     callback(callback),
+     context(context),
+     slot(slot) {}
+
+ensnare::AsyncDecl::AsyncDecl(Sym name, Str cpp_name, Str header, Params params,
+                              Opt<Type> value, Type future)
+   : name(name),
+     cpp_name(cpp_name),
+     header(header),
+     params(params),
+     value(value),
+     future(future) {}
+
 ensnare::VariableDeclObj::VariableDeclObj(Str name, Str cpp_name, Str header, Type type)
    : name(new_Sym(name)), cpp_name(cpp_name), header(header), type(type) {}
+
+ensnare::ConstantDeclObj::ConstantDeclObj(Str name, Type type, Expr value)
+   : name(new_Sym(name)), type(type), value(value) {}
+
+ensnare::ConstantDeclObj::ConstantDeclObj(Str name, Expr value)
+   : name(new_Sym(name)), value(value) {}
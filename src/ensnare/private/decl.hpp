@@ -26,14 +26,35 @@ class EnumTypeDecl {
    const Str cpp_name;
    const Str header;
    const Vec<EnumFieldDecl> fields;
-   EnumTypeDecl(Sym name, Str cpp_name, Str header, Vec<EnumFieldDecl> fields);
+   const Opt<U64> size; ///< In bytes, of the underlying integer type.
+   /// Every nonzero field is a distinct bit, starting at the first. A nim set of the bits is
+   /// generated alongside, with the same representation as the c++ integer.
+   const bool flags;
+   EnumTypeDecl(Sym name, Str cpp_name, Str header, Vec<EnumFieldDecl> fields, Opt<U64> size = {},
+                bool flags = false);
 };
 
 class RecordFieldDecl {
    public:
    const Sym name;
    const Type type;
+   const Opt<U64> offset; ///< In bytes, if the record has a known layout.
+   const Opt<U64> align;  ///< In bytes, from `alignas` or `__attribute__((aligned))`.
    RecordFieldDecl(Str name, Type type);
+   RecordFieldDecl(Str name, Type type, U64 offset, Opt<U64> align = {});
+};
+
+/// The layout clang computed for a complete record.
+class RecordLayout {
+   public:
+   const U64 size;  ///< In bytes.
+   const U64 align; ///< In bytes.
+   /// Nim can compute the same layout from the bound fields alone, so it can be a
+   /// `complete_struct` and the layout is asserted at compile time.
+   const bool complete;
+   const bool packed;      ///< `__attribute__((packed))`, fields are not padded.
+   const U64 pointer_size; ///< In bytes, of the target the layout was computed for.
+   RecordLayout(U64 size, U64 align, bool complete, bool packed, U64 pointer_size);
 };
 
 class TemplateParam {
@@ -57,7 +78,14 @@ class RecordTypeDecl {
    const Str header;
    const Opt<TemplateParams> template_params;
    const Vec<RecordFieldDecl> fields;
-   RecordTypeDecl(Sym name, Str cpp_name, Str header, Vec<RecordFieldDecl> fields);
+   /// Copies are plain memcpys and destruction is a no-op, so it is bound as a nim value type.
+   const bool trivially_copyable;
+   const Opt<RecordLayout> layout;
+   /// Laid out by nim as a plain object instead of imported, see `-shims`.
+   const bool plain;
+   RecordTypeDecl(Sym name, Str cpp_name, Str header, Vec<RecordFieldDecl> fields,
+                  bool trivially_copyable = false, Opt<RecordLayout> layout = {},
+                  bool plain = false);
    RecordTypeDecl(Sym name, Str cpp_name, Str header, TemplateParams template_params,
                   Vec<RecordFieldDecl> fields);
 };
@@ -85,6 +113,18 @@ class Param {
 
 using Params = Vec<Param>;
 
+/// Facts from the c++ declaration of a routine that nim can use to optimize calls to it.
+class RoutineAttrs {
+   public:
+   /// Declared to not throw, so nim does not need to track exceptions or unwind around a call.
+   const bool nothrow;
+   /// Declared `pure` or `const`, so calls can be hoisted and merged.
+   const bool no_side_effect;
+   /// The result may be dropped without a `discard`.
+   const bool discardable;
+   RoutineAttrs(bool nothrow = false, bool no_side_effect = false, bool discardable = false);
+};
+
 class FunctionDecl {
    public:
    const Sym name;
@@ -93,9 +133,28 @@ class FunctionDecl {
    const Opt<TemplateParams> template_params;
    const Params params;
    const Opt<Type> return_type;
-   FunctionDecl(Str name, Str cpp_name, Str header, Params params, Opt<Type> return_type);
+   const RoutineAttrs attrs;
+   FunctionDecl(Str name, Str cpp_name, Str header, Params params, Opt<Type> return_type,
+                RoutineAttrs attrs = {});
    FunctionDecl(Str name, Str cpp_name, Str header, TemplateParams template_params, Params params,
-                Opt<Type> return_type);
+                Opt<Type> return_type, RoutineAttrs attrs = {});
+};
+
+/// A function called through an `extern "C"` thunk that is compiled once, see `-shims`. The nim
+/// modules that call it do not include the headers it is declared in.
+class ShimDecl {
+   public:
+   const Sym name;
+   const Str symbol; ///< Of the thunk.
+   /// The receiver of a method or constructor, a `var` or `{.byref.}` object for the pointer the
+   /// thunk takes, or the type itself.
+   const Opt<Type> self;
+   const Params params;
+   const Opt<Type> return_type;
+   const RoutineAttrs attrs;
+   ShimDecl(Str name, Str symbol, Params params, Opt<Type> return_type, RoutineAttrs attrs = {});
+   ShimDecl(Str name, Str symbol, Type self, Params params, Opt<Type> return_type,
+            RoutineAttrs attrs = {});
 };
 
 class ConstructorDecl {
@@ -106,10 +165,11 @@ class ConstructorDecl {
    const Type self;
    const Opt<TemplateParams> template_params;
    const Params params;
+   const RoutineAttrs attrs;
    ConstructorDecl(Str cpp_name, Str header, Opt<TemplateParams> self_template_params, Type self,
-                   Params params);
+                   Params params, RoutineAttrs attrs = {});
    ConstructorDecl(Str cpp_name, Str header, Opt<TemplateParams> self_template_params, Type self,
-                   TemplateParams template_params, Params params);
+                   TemplateParams template_params, Params params, RoutineAttrs attrs = {});
 };
 
 class MethodDecl {
@@ -123,14 +183,107 @@ class MethodDecl {
    const Params params;
    const Opt<Type> return_type;
    const bool is_static;
+   const RoutineAttrs attrs;
    MethodDecl(Str name, Str cpp_name, Str header, Opt<TemplateParams> self_template_params,
-              Type self, Params params, Opt<Type> return_type, bool is_static = false);
+              Type self, Params params, Opt<Type> return_type, bool is_static = false,
+              RoutineAttrs attrs = {});
    MethodDecl(Str name, Str cpp_name, Str header, Opt<TemplateParams> self_template_params,
               Type self, TemplateParams template_params, Params params, Opt<Type> return_type,
-              bool is_static = false);
+              bool is_static = false, RoutineAttrs attrs = {});
 };
 
-using RoutineDeclObj = Union<FunctionDecl, ConstructorDecl, MethodDecl>;
+/// The lifetime hooks of the managed `Cpp[T]` wrapper for a class. Each one calls the matching
+/// c++ special member, or is a compile time error if the class does not provide it.
+class HooksDecl {
+   public:
+   const Str cpp_name;
+   const Str header;
+   const Type self;
+   const bool destructible;
+   const bool copyable;
+   const bool movable;
+   HooksDecl(Str cpp_name, Str header, Type self, bool destructible, bool copyable, bool movable);
+};
+
+/// Views of a class that stores its elements contiguously, like `std::vector` or
+/// `std::string_view`. They are found from its `data()` and `size()` members and let the elements
+/// cross into nim as an `openArray` without a copy.
+class ViewDecl {
+   public:
+   const Str header;
+   const Opt<TemplateParams> self_template_params;
+   const Type self;
+   const Type element;
+   /// There is a `(T*, size)` constructor, so a nim `openArray` can be viewed as the class too.
+   const bool from_open_array;
+   ViewDecl(Str header, Opt<TemplateParams> self_template_params, Type self, Type element,
+            bool from_open_array);
+};
+
+/// Nim iterators for a class with `begin()` and `end()`. They inline to the c++ iterator loop.
+class IteratorDecl {
+   public:
+   const Opt<TemplateParams> self_template_params;
+   const Type self;
+   const Type iterator; ///< The type `begin()` returns.
+   const Type element;
+   /// Dereferencing yields a reference, so elements are not copied.
+   const bool by_ref;
+   /// The reference is not const, so `mitems` can be bound.
+   const bool mutable_elements;
+   IteratorDecl(Opt<TemplateParams> self_template_params, Type self, Type iterator, Type element,
+                bool by_ref, bool mutable_elements);
+};
+
+/// An overload of a function that takes a nim closure in place of a c callback. The closure is
+/// passed by address through the callback's context pointer, or through a `std::function` that
+/// holds the two pointers inline, to a `cdecl` trampoline. Nothing is allocated, so the callback
+/// must not be kept after the call returns.
+class TrampolineDecl {
+   public:
+   const Sym name;
+   const Params params; ///< Of the function being overloaded.
+   const Opt<Type> return_type;
+   const Size callback; ///< The index of the callback parameter.
+   /// The index of the `void*` parameter passed back to the callback. There is none for a
+   /// `std::function`.
+   const Opt<Size> context;
+   const Type signature; ///< The closure's `FuncType`, which is the callback without the context.
+   const Size slot;      ///< Where the context goes in the trampoline's parameters.
+   /// The `std::function` type of the callback, if it is one.
+   const Opt<Type> function;
+   const Opt<TemplateParams> self_template_params;
+   const Opt<Type> self; ///< The class of the method being overloaded, none for a function.
+   const bool is_static;
+   TrampolineDecl(Sym name, Params params, Opt<Type> return_type, Size callback,
+                  Opt<Size> context, Type signature, Size slot, Opt<Type> function,
+                  Opt<TemplateParams> self_template_params = {}, Opt<Type> self = {},
+                  bool is_static = false);
+};
+
+/// A nim async wrapper, `<name>_async`, of a function that finishes later. It either calls a
+/// completion callback with a context pointer, or returns a `std::future`. Either way the wrapper
+/// returns a nim `Future` and never blocks.
+class AsyncDecl {
+   public:
+   const Sym name;
+   const Str cpp_name;
+   const Str header;
+   const Params params;   ///< Of the function being wrapped.
+   const Opt<Type> value; ///< What the future completes with.
+   /// The index of the completion callback. There is none when a `std::future` is returned.
+   const Opt<Size> callback;
+   const Opt<Size> context; ///< The index of the `void*` passed back to the callback.
+   const Opt<Size> slot;    ///< Where the context goes in the callback's parameters.
+   /// The `std::future` type returned, if that is how the function completes.
+   const Opt<Type> future;
+   AsyncDecl(Sym name, Str cpp_name, Str header, Params params, Opt<Type> value, Size callback,
+             Size context, Size slot);
+   AsyncDecl(Sym name, Str cpp_name, Str header, Params params, Opt<Type> value, Type future);
+};
+
+using RoutineDeclObj = Union<FunctionDecl, ShimDecl, ConstructorDecl, MethodDecl, HooksDecl,
+                             ViewDecl, IteratorDecl, TrampolineDecl, AsyncDecl>;
 using RoutineDecl = Node<RoutineDeclObj>;
 
 template <typename T> RoutineDecl new_RoutineDecl(T routine_decl) {
@@ -151,4 +304,20 @@ using VariableDecl = Node<VariableDeclObj>;
 template <typename... Args> VariableDecl new_VariableDecl(Args... args) {
    return node<VariableDeclObj>(args...);
 }
+
+/// A value known at compile time. Bound as a nim `const` so it folds and can size arrays.
+class ConstantDeclObj {
+   public:
+   const Sym name;
+   const Opt<Type> type; ///< Left to nim to infer if missing, like for macros.
+   const Expr value;
+   ConstantDeclObj(Str name, Type type, Expr value);
+   ConstantDeclObj(Str name, Expr value);
+};
+
+using ConstantDecl = Node<ConstantDeclObj>;
+
+template <typename... Args> ConstantDecl new_ConstantDecl(Args... args) {
+   return node<ConstantDeclObj>(args...);
+}
 } // namespace ensnare
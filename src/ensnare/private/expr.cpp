@@ -3,3 +3,9 @@
 using namespace ensnare;
 
 ensnare::ConstParamExpr::ConstParamExpr(Sym name) : name(name) {}
+
+ensnare::BinaryExpr::BinaryExpr(Str op, Expr lhs, Expr rhs) : op(op), lhs(lhs), rhs(rhs) {}
+
+ensnare::UnaryExpr::UnaryExpr(Str op, Expr operand) : op(op), operand(operand) {}
+
+ensnare::ConvExpr::ConvExpr(Sym type, Expr operand) : type(type), operand(operand) {}
@@ -6,14 +6,19 @@
 namespace ensnare {
 template <typename T> class LitExpr;
 class ConstParamExpr;
+class BinaryExpr;
+class UnaryExpr;
+class ConvExpr;
 
 /// Used within an Expr.
-using ExprObj = Union<LitExpr<U64>, LitExpr<I64>, ConstParamExpr>;
+using ExprObj = Union<LitExpr<U64>, LitExpr<I64>, LitExpr<F64>, LitExpr<bool>, LitExpr<Str>,
+                      ConstParamExpr, BinaryExpr, UnaryExpr, ConvExpr>;
 
 /// Roughly maps to clang::Expr.
 /// Uses:
 ///    constant generic expressions that we cannot resolve (can we ever resolve them? idk i'm drunk)
 ///    default arguments
+///    the values of constants
 /// It may be used to translate templates or even entire headers wholesale.
 using Expr = Node<ExprObj>;
 
@@ -31,5 +36,33 @@ class ConstParamExpr {
    ConstParamExpr(Sym name);
 };
 
+/// A binary operator over expressions that depend on template parameters. `op` is the nim
+/// operator.
+class BinaryExpr {
+   public:
+   const Str op;
+   const Expr lhs;
+   const Expr rhs;
+   BinaryExpr(Str op, Expr lhs, Expr rhs);
+};
+
+/// A unary operator over an expression that depends on template parameters. `op` is the nim
+/// operator.
+class UnaryExpr {
+   public:
+   const Str op;
+   const Expr operand;
+   UnaryExpr(Str op, Expr operand);
+};
+
+/// A conversion to a named type: `type(operand)`. Nim does not convert integers to enums or chars
+/// implicitly.
+class ConvExpr {
+   public:
+   const Sym type;
+   const Expr operand;
+   ConvExpr(Sym type, Expr operand);
+};
+
 template <typename T> Expr new_Expr(T expr) { return node<ExprObj>(expr); }
 } // namespace ensnare
@@ -48,3 +48,14 @@ Opt<Str> ensnare::HeaderCanonicalizer::operator[](const clang::SourceLocation& l
       return {};
    }
 }
+
+Opt<Str> ensnare::HeaderCanonicalizer::includer(clang::SourceLocation loc) {
+   loc = source_manager.getExpansionLoc(loc);
+   while (loc.isValid()) {
+      if (auto header = (*this)[loc]) {
+         return header;
+      }
+      loc = source_manager.getIncludeLoc(source_manager.getFileID(loc));
+   }
+   return {};
+}
@@ -15,5 +15,7 @@ class HeaderCanonicalizer {
    public:
    HeaderCanonicalizer(const Config& cfg, const clang::SourceManager& source_manager);
    Opt<Str> operator[](const clang::SourceLocation& loc);
+   /// The nearest header that includes `loc`, directly or through others.
+   Opt<Str> includer(clang::SourceLocation loc);
 };
 } // namespace ensnare
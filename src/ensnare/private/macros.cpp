@@ -0,0 +1,269 @@
+#include "ensnare/private/macros.hpp"
+
+#include "clang/Lex/LiteralSupport.h"
+#include "clang/Lex/MacroInfo.h"
+
+#include <algorithm>
+
+using namespace ensnare;
+
+/// A partially evaluated macro. Integers are always 64 bits wide.
+using Value = Union<llvm::APSInt, F64, Str>;
+
+/// Nested macros are expanded up to this depth. It also stops self referential macros.
+const Size max_expansion_depth = 16;
+
+/// Expand `info` and any object-like macros it references into `result`.
+bool expand(clang::Preprocessor& pp, const clang::MacroInfo& info, Size depth,
+            Vec<clang::Token>& result) {
+   if (depth > max_expansion_depth || info.isFunctionLike()) {
+      return false;
+   }
+   for (const auto& token : info.tokens()) {
+      if (token.is(clang::tok::identifier)) {
+         auto nested = pp.getMacroInfo(token.getIdentifierInfo());
+         if (!nested || !expand(pp, *nested, depth + 1, result)) {
+            return false;
+         }
+      } else {
+         result.push_back(token);
+      }
+   }
+   return true;
+}
+
+/// C precedence of the supported binary operators, higher binds tighter.
+Opt<int> precedence(clang::tok::TokenKind kind) {
+   switch (kind) {
+      case clang::tok::pipe: return 1;
+      case clang::tok::caret: return 2;
+      case clang::tok::amp: return 3;
+      case clang::tok::lessless:
+      case clang::tok::greatergreater: return 4;
+      case clang::tok::plus:
+      case clang::tok::minus: return 5;
+      case clang::tok::star:
+      case clang::tok::slash:
+      case clang::tok::percent: return 6;
+      default: return {};
+   }
+}
+
+Opt<Value> apply(clang::tok::TokenKind op, llvm::APSInt lhs, llvm::APSInt rhs) {
+   // The usual arithmetic conversions: if either side is unsigned both are.
+   auto is_unsigned = lhs.isUnsigned() || rhs.isUnsigned();
+   lhs.setIsUnsigned(is_unsigned);
+   rhs.setIsUnsigned(is_unsigned);
+   switch (op) {
+      case clang::tok::plus: return Value(lhs + rhs);
+      case clang::tok::minus: return Value(lhs - rhs);
+      case clang::tok::star: return Value(lhs * rhs);
+      case clang::tok::slash: return rhs == 0 ? Opt<Value>() : Value(lhs / rhs);
+      case clang::tok::percent: return rhs == 0 ? Opt<Value>() : Value(lhs % rhs);
+      case clang::tok::amp: return Value(lhs & rhs);
+      case clang::tok::pipe: return Value(lhs | rhs);
+      case clang::tok::caret: return Value(lhs ^ rhs);
+      case clang::tok::lessless:
+      case clang::tok::greatergreater:
+         if (rhs.isNegative() || rhs.getZExtValue() >= lhs.getBitWidth()) {
+            return {};
+         } else if (op == clang::tok::lessless) {
+            return Value(lhs << rhs.getZExtValue());
+         } else {
+            return Value(lhs >> rhs.getZExtValue());
+         }
+      default: return {};
+   }
+}
+
+F64 to_float(const Value& value) {
+   if (is<llvm::APSInt>(value)) {
+      const auto& i = as<llvm::APSInt>(value);
+      return i.isUnsigned() ? F64(i.getZExtValue()) : F64(i.getSExtValue());
+   } else {
+      return as<F64>(value);
+   }
+}
+
+Opt<Value> apply(clang::tok::TokenKind op, const Value& lhs, const Value& rhs) {
+   if (is<Str>(lhs) || is<Str>(rhs)) {
+      return {};
+   } else if (is<llvm::APSInt>(lhs) && is<llvm::APSInt>(rhs)) {
+      return apply(op, as<llvm::APSInt>(lhs), as<llvm::APSInt>(rhs));
+   } else {
+      auto a = to_float(lhs);
+      auto b = to_float(rhs);
+      switch (op) {
+         case clang::tok::plus: return Value(a + b);
+         case clang::tok::minus: return Value(a - b);
+         case clang::tok::star: return Value(a * b);
+         case clang::tok::slash: return Value(a / b);
+         default: return {};
+      }
+   }
+}
+
+/// A precedence climbing parser over the expanded tokens of a macro.
+class MacroParser {
+   clang::Preprocessor& pp;
+   const Vec<clang::Token>& tokens;
+   Size i = 0;
+
+   bool at(clang::tok::TokenKind kind) const { return i < tokens.size() && tokens[i].is(kind); }
+
+   Opt<Value> numeric(const clang::Token& token) {
+      llvm::SmallString<32> buffer;
+      auto invalid = false;
+      auto spelling = pp.getSpelling(token, buffer, &invalid);
+      if (invalid) {
+         return {};
+      }
+      clang::NumericLiteralParser literal(spelling, token.getLocation(), pp);
+      if (literal.hadError || literal.hasUDSuffix() || literal.isImaginary ||
+          literal.isFixedPointLiteral()) {
+         return {};
+      } else if (literal.isIntegerLiteral()) {
+         llvm::APInt value(64, 0);
+         if (literal.GetIntegerValue(value)) {
+            return {}; // Too big for 64 bits.
+         }
+         // Like c, a literal that does not fit a signed integer is unsigned.
+         return Value(llvm::APSInt(value, literal.isUnsigned || value.isNegative()));
+      } else if (literal.isFloatingLiteral()) {
+         llvm::APFloat value(llvm::APFloat::IEEEdouble());
+         literal.GetFloatValue(value);
+         return Value(value.convertToDouble());
+      } else {
+         return {};
+      }
+   }
+
+   /// Adjacent string literals are concatenated.
+   Opt<Value> string() {
+      Vec<clang::Token> run;
+      while (i < tokens.size() && clang::tok::isStringLiteral(tokens[i].getKind())) {
+         run.push_back(tokens[i]);
+         i += 1;
+      }
+      clang::StringLiteralParser literal(run, pp);
+      if (literal.hadError || !(literal.isAscii() || literal.isUTF8())) {
+         return {};
+      } else {
+         return Value(literal.GetString().str());
+      }
+   }
+
+   Opt<Value> unary() {
+      if (i == tokens.size()) {
+         return {};
+      }
+      const auto& token = tokens[i];
+      if (clang::tok::isStringLiteral(token.getKind())) {
+         return string();
+      }
+      i += 1;
+      switch (token.getKind()) {
+         case clang::tok::numeric_constant: return numeric(token);
+         case clang::tok::l_paren: {
+            auto result = binary(1);
+            if (result && at(clang::tok::r_paren)) {
+               i += 1;
+               return result;
+            } else {
+               return {};
+            }
+         }
+         case clang::tok::plus: {
+            auto operand = unary();
+            return operand && !is<Str>(*operand) ? operand : Opt<Value>();
+         }
+         case clang::tok::minus: {
+            auto operand = unary();
+            if (operand && is<llvm::APSInt>(*operand)) {
+               return Value(-as<llvm::APSInt>(*operand));
+            } else if (operand && is<F64>(*operand)) {
+               return Value(-as<F64>(*operand));
+            } else {
+               return {};
+            }
+         }
+         case clang::tok::tilde: {
+            auto operand = unary();
+            if (operand && is<llvm::APSInt>(*operand)) {
+               return Value(~as<llvm::APSInt>(*operand));
+            } else {
+               return {};
+            }
+         }
+         default: return {};
+      }
+   }
+
+   Opt<Value> binary(int min_precedence) {
+      auto lhs = unary();
+      while (lhs && i < tokens.size()) {
+         auto op = tokens[i].getKind();
+         auto op_precedence = precedence(op);
+         if (!op_precedence || *op_precedence < min_precedence) {
+            break;
+         }
+         i += 1;
+         auto rhs = binary(*op_precedence + 1);
+         lhs = rhs ? apply(op, *lhs, *rhs) : Opt<Value>();
+      }
+      return lhs;
+   }
+
+   public:
+   MacroParser(clang::Preprocessor& pp, const Vec<clang::Token>& tokens)
+      : pp(pp), tokens(tokens) {}
+
+   /// The value of the whole token sequence, if it is a constant expression.
+   Opt<Value> parse() {
+      auto result = binary(1);
+      return i == tokens.size() ? result : Opt<Value>();
+   }
+};
+
+Expr to_expr(const Value& value) {
+   if (is<llvm::APSInt>(value)) {
+      const auto& i = as<llvm::APSInt>(value);
+      return i.isUnsigned() ? new_Expr(LitExpr<U64>(i.getZExtValue()))
+                            : new_Expr(LitExpr<I64>(i.getSExtValue()));
+   } else if (is<F64>(value)) {
+      return new_Expr(LitExpr<F64>(as<F64>(value)));
+   } else {
+      return new_Expr(LitExpr<Str>(as<Str>(value)));
+   }
+}
+
+Opt<Expr> ensnare::eval_macro(clang::Preprocessor& pp, const clang::MacroInfo& info) {
+   Vec<clang::Token> tokens;
+   if (expand(pp, info, 0, tokens) && tokens.size() != 0) {
+      if (auto value = MacroParser(pp, tokens).parse()) {
+         return to_expr(*value);
+      }
+   }
+   return {};
+}
+
+Vec<std::pair<const clang::IdentifierInfo*, const clang::MacroInfo*>>
+ensnare::object_macros(clang::Preprocessor& pp) {
+   Vec<std::pair<const clang::IdentifierInfo*, const clang::MacroInfo*>> result;
+   auto& source_manager = pp.getSourceManager();
+   for (const auto& [ident, state] : pp.macros()) {
+      auto info = pp.getMacroInfo(ident);
+      // Predefined and command line macros have no file.
+      if (info && !info->isBuiltinMacro() && !info->isFunctionLike() &&
+          !info->isUsedForHeaderGuard() && info->getNumTokens() != 0 &&
+          !source_manager.getFilename(info->getDefinitionLoc()).empty()) {
+         result.push_back({ident, info});
+      }
+   }
+   // The macro table is a hash map, keep the output stable.
+   std::sort(result.begin(), result.end(), [&](const auto& a, const auto& b) {
+      return source_manager.isBeforeInTranslationUnit(a.second->getDefinitionLoc(),
+                                                      b.second->getDefinitionLoc());
+   });
+   return result;
+}
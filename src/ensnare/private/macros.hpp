@@ -0,0 +1,20 @@
+/// \file
+/// Evaluation of object-like preprocessor macros to constants.
+
+#pragma once
+
+#include "ensnare/private/clang_utils.hpp"
+#include "ensnare/private/expr.hpp"
+
+#include "clang/Lex/Preprocessor.h"
+
+namespace ensnare {
+/// Evaluate an object-like macro that expands to an integer, float or string constant expression.
+/// Other object-like macros it references are expanded. Anything else, like casts, function-like
+/// macros or references to declarations, is rejected.
+Opt<Expr> eval_macro(clang::Preprocessor& pp, const clang::MacroInfo& info);
+
+/// The object-like macros currently defined, in the order they were defined.
+Vec<std::pair<const clang::IdentifierInfo*, const clang::MacroInfo*>>
+object_macros(clang::Preprocessor& pp);
+} // namespace ensnare
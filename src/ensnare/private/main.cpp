@@ -1,5 +1,6 @@
 #include "ensnare/private/main.hpp"
 
+#include "ensnare/private/async.hpp"
 #include "ensnare/private/bit_utils.hpp"
 #include "ensnare/private/builtins.hpp"
 #include "ensnare/private/clang_utils.hpp"
@@ -7,28 +8,16 @@
 #include "ensnare/private/decl.hpp"
 #include "ensnare/private/header_canonicalizer.hpp"
 #include "ensnare/private/headers.hpp"
+#include "ensnare/private/macros.hpp"
 #include "ensnare/private/render.hpp"
 #include "ensnare/private/runtime.hpp"
 #include "ensnare/private/str_utils.hpp"
 #include "ensnare/private/sym_generator.hpp"
 #include "ensnare/private/utils.hpp"
 
-/* FIXME: c++ template methods with explicit arguments
-template <std::size_t size, typename T> class Vec {
-   template <typename U> int some_meth(T val);
-}
-
-proc some_meth*[size: static[CppSize]; T; U](�: Vec[size, T], val: T): CppInt
-
-Consider the template method where the `U` template parameter cannot be inferred.
-In nim we would like to call it like some_vec.some_meth[:int](2.0) where the first two are inferred.
-Nim generic instantiations seem to be all or nothing so we can't do that. Instead we should be
-determine if a template parameter can be inferred. If it can't we insert typedesc arguments.
+#include "clang/Frontend/FrontendActions.h"
 
-proc some_meth*[size: static[CppSize]; T; U](�: Vec[size, T], �1: type[U], val: T): CppInt
-
-Calling it like: some_vec.some_meth(int, 2.0)
-*/
+#include <cctype>
 
 /* FIXME: SFINAE
 Much of <type_trait> can be translated to nim's generic constaints.
@@ -42,7 +31,8 @@ Cross compilation is already exposed with `--disable-include-search-paths` and c
 */
 
 /* FIXME: preprocessor imrofation
-clang offers some PP information that could be exposed as constants and templates.
+Object-like macros that evaluate to constants are bound, see wrap_macros.
+Function-like macros could be exposed as templates.
 */
 
 // FIXME: Introspection is key to producing nice wrappers. For that we need a more procedural api.
@@ -53,18 +43,6 @@ clang offers some PP information that could be exposed as constants and template
 
 // FIXME: namespace handling
 
-/* FIXME: rvalue reference handling is broken.
-consider:
-void func(Foo&& blah) {}
-void func(Foo& blah) {}
-void func(Foo blah) {}
-
-These will produce a nim redefinition error because rvalue refernences are transparent.
-Simply ignoring functions with rvalue ref loses information if the function is not overloaded.
-We may have to simulate overloads ourselves.
-Perhaps using the nim compiler's machinery.
-*/
-
 /* FIXME: Avoiding rebinding the world.
 We want to be able to load already bound libraries and reference those.
 Using the compiler again?
@@ -87,6 +65,8 @@ class Context {
    Vec<TypeDecl> _type_decls;
    Vec<RoutineDecl> _routine_decls;
    Vec<VariableDecl> _variable_decls;
+   Vec<ConstantDecl> _constant_decls;
+   Vec<Str> _thunks;
 
    HeaderCanonicalizer header_canonicalizer; ///< Each declaration we bind must have a header to
                                              ///< otherwise we would get nim backend errors.
@@ -100,6 +80,10 @@ class Context {
    const Vec<RoutineDecl>& routine_decls() const { return _routine_decls; }
    /// The variables we have bound.
    const Vec<VariableDecl>& variable_decls() const { return _variable_decls; }
+   /// The constants we have folded.
+   const Vec<ConstantDecl>& constant_decls() const { return _constant_decls; }
+   /// The `extern "C"` thunks of the shims, see ShimDecl.
+   const Vec<Str>& thunks() const { return _thunks; }
 
    private:
    Vec<const clang::NamedDecl*> decl_stack; ///< To give anonymous tags useful names, we track
@@ -170,21 +154,45 @@ class Context {
    /// Add a variable declaration to be rendered.
    void add(const VariableDecl decl) { _variable_decls.push_back(decl); }
 
+   /// Add a constant declaration to be rendered.
+   void add(const ConstantDecl decl) { _constant_decls.push_back(decl); }
+
+   /// Add a thunk to the shims source.
+   void add_thunk(Str thunk) { _thunks.push_back(thunk); }
+
    /// Filters access to protected and private members.
    bool access_guard(const clang::Decl& decl) const {
       return decl.getAccess() == clang::AS_public || decl.getAccess() == clang::AS_none;
    }
 
+   /// Where `decl` is declared for finding its header.
+   static clang::SourceLocation header_location(const clang::NamedDecl& decl) {
+      // An instantiation can be written anywhere, it is declared with its template.
+      if (auto spec = llvm::dyn_cast<clang::ClassTemplateSpecializationDecl>(&decl)) {
+         return spec->getSpecializedTemplate()->getLocation();
+      } else {
+         return decl.getLocation();
+      }
+   }
+
    /// See Context::header_canonicalizer
    Opt<Str> maybe_header(const clang::NamedDecl& decl) {
-      return header_canonicalizer[decl.getLocation()];
+      return header_canonicalizer[header_location(decl)];
    }
 
+   /// See Context::header_canonicalizer
+   Opt<Str> maybe_header(const clang::SourceLocation& loc) { return header_canonicalizer[loc]; }
+
    /// See Context::header_canonicalizer
    Str header(const clang::NamedDecl& decl) {
       auto h = maybe_header(decl);
+      // Only bound because something else uses it, like a standard library type. It is imported
+      // through the header that brings it in.
+      if (!h) {
+         h = header_canonicalizer.includer(header_location(decl));
+      }
       if (h) {
-         return *h;
+         return cfg.umbrella() ? cfg.umbrella_header() : *h;
       } else {
          write(render(decl));
          fatal("failed to canonicalize source location");
@@ -348,19 +356,21 @@ Type map(Context& ctx, const clang::BuiltinType& entity) {
 
 /// Map a const/volatile/__restrict qualified type.
 Type map(Context& ctx, const clang::QualType& entity) {
-   // Too niche to care about for now.
-   //  if (entity.isRestrictQualified() || entity.isVolatileQualified()) {
-   //    fatal("volatile and restrict qualifiers unsupported");
-   // }
    auto type = entity.getTypePtr();
    if (type) {
       auto result = map(ctx, *type);
+      if (entity.isVolatileQualified()) {
+         result = new_Type(VolatileType(result));
+      }
       // FIXME: `isLocalConstQualified`: do we care about local vs non-local?
       if (entity.isConstQualified() && !ctx.cfg.ignore_const()) {
-         return new_Type(ConstType(result));
-      } else {
-         return result;
+         result = new_Type(ConstType(result));
       }
+      // Outermost so a parameter can see it, see `render(const Param&, int)`.
+      if (entity.isRestrictQualified()) {
+         result = new_Type(RestrictType(result));
+      }
+      return result;
    } else {
       fatal("QualType inner type was null");
    }
@@ -419,19 +429,161 @@ Type map_templ_param(Context& ctx, const clang::NamedDecl& decl) {
    return map(ctx, decl);
 }
 
-Expr map_expr(Context& ctx, const clang::Expr& expr) {
+/// Fold a constant integer to a nim literal of the same signedness.
+Opt<Expr> fold_int(const llvm::APSInt& value) {
+   if (value.isSigned() && value.getMinSignedBits() <= 64) {
+      return new_Expr(LitExpr<I64>(value.getExtValue()));
+   } else if (value.isUnsigned() && value.getActiveBits() <= 64) {
+      return new_Expr(LitExpr<U64>(value.getZExtValue()));
+   } else {
+      return {};
+   }
+}
+
+/// Fold a constant float to a nim literal. Nim has no wider float than `float64`.
+Expr fold_float(llvm::APFloat value) {
+   bool loses_info;
+   value.convert(llvm::APFloat::IEEEdouble(), llvm::APFloat::rmNearestTiesToEven, &loses_info);
+   return new_Expr(LitExpr<F64>(value.convertToDouble()));
+}
+
+/// Fold an evaluated arithmetic value of `type` to a nim literal.
+Opt<Expr> fold_value(const clang::APValue& value, clang::QualType type) {
+   if (value.isInt() && type->isBooleanType()) {
+      return new_Expr(LitExpr<bool>(value.getInt().getBoolValue()));
+   } else if (value.isInt()) {
+      return fold_int(value.getInt());
+   } else if (value.isFloat()) {
+      return fold_float(value.getFloat());
+   } else {
+      return {};
+   }
+}
+
+/// Fold an expression that is not value dependent with clang's constant evaluator.
+Opt<Expr> fold_expr(Context& ctx, const clang::Expr& expr) {
+   clang::Expr::EvalResult result;
+   if (!expr.isValueDependent() && expr.EvaluateAsRValue(result, ctx.ast_ctx) &&
+       !result.HasSideEffects) {
+      return fold_value(result.Val, expr.getType());
+   } else {
+      return {};
+   }
+}
+
+Opt<Str> operator_name(clang::BinaryOperatorKind op) {
+   switch (op) {
+      case clang::BO_Add: return "+";
+      case clang::BO_Sub: return "-";
+      case clang::BO_Mul: return "*";
+      case clang::BO_Div: return "div";
+      case clang::BO_Rem: return "mod";
+      case clang::BO_Shl: return "shl";
+      case clang::BO_Shr: return "shr";
+      case clang::BO_And:
+      case clang::BO_LAnd: return "and";
+      case clang::BO_Or:
+      case clang::BO_LOr: return "or";
+      case clang::BO_Xor: return "xor";
+      case clang::BO_LT: return "<";
+      case clang::BO_GT: return ">";
+      case clang::BO_LE: return "<=";
+      case clang::BO_GE: return ">=";
+      case clang::BO_EQ: return "==";
+      case clang::BO_NE: return "!=";
+      default: return {};
+   }
+}
+
+Opt<Str> operator_name(clang::UnaryOperatorKind op) {
+   switch (op) {
+      case clang::UO_Plus: return "+";
+      case clang::UO_Minus: return "-";
+      case clang::UO_Not:
+      case clang::UO_LNot: return "not";
+      default: return {};
+   }
+}
+
+/// Map an expression. Anything clang can evaluate is folded to a literal, the rest must be
+/// built from template parameters.
+Opt<Expr> try_map_expr(Context& ctx, const clang::Expr& expr) {
+   if (auto folded = fold_expr(ctx, expr)) {
+      return folded;
+   }
    switch (expr.getStmtClass()) {
       // This should be a non type template parameter. Probably innacurate now.
       case clang::Stmt::DeclRefExprClass: {
-         auto templ_param = wrap_templ_param(ctx, *llvm::cast<clang::DeclRefExpr>(expr).getDecl());
-         return new_Expr(ConstParamExpr(templ_param->name));
+         auto decl = llvm::cast<clang::DeclRefExpr>(expr).getDecl();
+         if (llvm::isa<clang::NonTypeTemplateParmDecl>(decl)) {
+            return new_Expr(ConstParamExpr(wrap_templ_param(ctx, *decl)->name));
+         } else {
+            return {};
+         }
       }
-      case clang::Stmt::IntegerLiteralClass: {
-         auto& int_expr = llvm::cast<clang::IntegerLiteral>(expr);
-         // FIXME: this should handle U64 too by checking the type.
-         return new_Expr(LitExpr<I64>(int_expr.getValue().getSExtValue()));
+      case clang::Stmt::ParenExprClass:
+         return try_map_expr(ctx, *llvm::cast<clang::ParenExpr>(expr).getSubExpr());
+      case clang::Stmt::ImplicitCastExprClass:
+      case clang::Stmt::CStyleCastExprClass:
+      case clang::Stmt::CXXFunctionalCastExprClass:
+      case clang::Stmt::CXXStaticCastExprClass: {
+         auto& cast = llvm::cast<clang::CastExpr>(expr);
+         auto operand = try_map_expr(ctx, *cast.getSubExpr());
+         if (!operand) {
+            return {};
+         }
+         switch (cast.getCastKind()) {
+            // Nim has no truthiness, and its `not`, `and` and `or` are bitwise on integers.
+            case clang::CK_IntegralToBoolean:
+            case clang::CK_FloatingToBoolean:
+               return new_Expr(BinaryExpr("!=", *operand, new_Expr(LitExpr<I64>(0))));
+            // Nor does it promote a bool to an integer.
+            case clang::CK_IntegralCast:
+               if (cast.getSubExpr()->getType()->isBooleanType()) {
+                  auto type = map(ctx, cast.getType());
+                  if (is<Sym>(type)) {
+                     return new_Expr(ConvExpr(as<Sym>(type), *operand));
+                  }
+               }
+               return operand;
+            // Nim converts the literals and parameters anything else can produce implicitly.
+            default: return operand;
+         }
       }
-      default: write(render(expr)); fatal("unhandled map_expr");
+      case clang::Stmt::SubstNonTypeTemplateParmExprClass:
+         return try_map_expr(
+             ctx, *llvm::cast<clang::SubstNonTypeTemplateParmExpr>(expr).getReplacement());
+      case clang::Stmt::BinaryOperatorClass: {
+         auto& op = llvm::cast<clang::BinaryOperator>(expr);
+         auto name = operator_name(op.getOpcode());
+         auto lhs = try_map_expr(ctx, *op.getLHS());
+         auto rhs = try_map_expr(ctx, *op.getRHS());
+         if (name && lhs && rhs) {
+            return new_Expr(BinaryExpr(*name, *lhs, *rhs));
+         } else {
+            return {};
+         }
+      }
+      case clang::Stmt::UnaryOperatorClass: {
+         auto& op = llvm::cast<clang::UnaryOperator>(expr);
+         auto name = operator_name(op.getOpcode());
+         auto operand = try_map_expr(ctx, *op.getSubExpr());
+         if (name && operand) {
+            return new_Expr(UnaryExpr(*name, *operand));
+         } else {
+            return {};
+         }
+      }
+      default: return {};
+   }
+}
+
+Expr map_expr(Context& ctx, const clang::Expr& expr) {
+   if (auto result = try_map_expr(ctx, expr)) {
+      return *result;
+   } else {
+      write(render(expr));
+      fatal("unhandled map_expr");
    }
 }
 
@@ -464,10 +616,43 @@ template <typename T> Opt<Type> map_return_type(Context& ctx, const T& entity) {
    if (result->isVoidType()) {
       return {};
    } else {
-      return map(ctx, result);
+      // A returned `T&&` is an expiring value, nim takes ownership of it as a `T`.
+      return map(ctx, result->isRValueReferenceType() ? result.getNonReferenceType() : result);
    }
 }
 
+/// The arguments of a template instantiation.
+Vec<InstType::Arg> inst_args(Context& ctx, llvm::ArrayRef<clang::TemplateArgument> arguments) {
+   Vec<InstType::Arg> args;
+   for (auto arg : arguments) {
+      switch (arg.getKind()) {
+         case clang::TemplateArgument::Type: args.emplace_back(map(ctx, arg.getAsType())); break;
+         case clang::TemplateArgument::Expression:
+            args.emplace_back(map_expr(ctx, *arg.getAsExpr()));
+            break;
+         case clang::TemplateArgument::Integral:
+            if (arg.getIntegralType()->isBooleanType()) {
+               args.emplace_back(new_Expr(LitExpr<bool>(arg.getAsIntegral().getBoolValue())));
+            } else if (auto folded = fold_int(arg.getAsIntegral())) {
+               args.emplace_back(*folded);
+            } else {
+               fatal("template argument too wide: ", render(arg));
+            }
+            break;
+         case clang::TemplateArgument::Null:
+         case clang::TemplateArgument::Declaration:
+         case clang::TemplateArgument::NullPtr:
+         case clang::TemplateArgument::Template:
+         case clang::TemplateArgument::TemplateExpansion:
+         case clang::TemplateArgument::Pack:
+         default:
+            print(render(arg));
+            fatal("unhandled inst template argument: ", render(arg.getKind()));
+      }
+   }
+   return args;
+}
+
 Type map(Context& ctx, const clang::Type& type) {
    switch (type.getTypeClass()) {
       case clang::Type::TypeClass::Elaborated:
@@ -475,14 +660,33 @@ Type map(Context& ctx, const clang::Type& type) {
          // in the clang AST. We care about semantics so we can ignore this.
          return map(ctx, llvm::cast<clang::ElaboratedType>(type).getNamedType());
       // If something has a decl representation, map that.
-      case clang::Type::TypeClass::Typedef:
-         return map(ctx, llvm::cast<clang::TypedefType>(type).getDecl());
-      case clang::Type::TypeClass::Record:
-         return map(ctx, get_definition(llvm::cast<clang::RecordType>(type).getDecl()));
+      case clang::Type::TypeClass::Typedef: {
+         auto decl = llvm::cast<clang::TypedefType>(type).getDecl();
+         // Member typedefs of an instantiation, like `std::vector<int>::size_type`, have no nim
+         // name of their own.
+         if (llvm::isa<clang::ClassTemplateSpecializationDecl>(decl->getDeclContext())) {
+            return map(ctx, decl->getUnderlyingType());
+         } else {
+            return map(ctx, decl);
+         }
+      }
+      case clang::Type::TypeClass::Record: {
+         const auto& decl = get_definition(llvm::cast<clang::RecordType>(type).getDecl());
+         // An instantiation that was not requested is its generic type applied to its arguments.
+         auto spec = llvm::dyn_cast<clang::ClassTemplateSpecializationDecl>(&decl);
+         if (spec && !ctx.lookup(*spec)) {
+            return new_Type(InstType(map(ctx, *spec->getSpecializedTemplate()),
+                                     inst_args(ctx, spec->getTemplateArgs().asArray())));
+         } else {
+            return map(ctx, decl);
+         }
+      }
       case clang::Type::TypeClass::Enum:
          return map(ctx, get_definition(llvm::cast<clang::EnumType>(type).getDecl()));
       case clang::Type::TemplateTypeParm:
          return map_templ_param(ctx, *llvm::cast<clang::TemplateTypeParmType>(type).getDecl());
+      case clang::Type::SubstTemplateTypeParm:
+         return map(ctx, llvm::cast<clang::SubstTemplateTypeParmType>(type).getReplacementType());
       case clang::Type::TypeClass::Pointer: {
          auto& ty = llvm::cast<clang::PointerType>(type);
          if (ty.isVoidPointerType()) { // `void*` is `pointer`
@@ -492,13 +696,30 @@ Type map(Context& ctx, const clang::Type& type) {
          }
       }
       case clang::Type::TypeClass::RValueReference:
-         return map(ctx, llvm::cast<clang::ReferenceType>(type).getPointeeType());
-      case clang::Type::TypeClass::LValueReference:
-         return fold_func<RefType>(ctx, llvm::cast<clang::ReferenceType>(type));
+         return fold_func<RValueRefType>(ctx, llvm::cast<clang::ReferenceType>(type));
+      case clang::Type::TypeClass::LValueReference: {
+         auto& ty = llvm::cast<clang::ReferenceType>(type);
+         auto pointee = ty.getPointeeType();
+         if (pointee.isConstQualified() && !pointee.isVolatileQualified() &&
+             !ctx.cfg.ignore_const()) {
+            return new_Type(ConstRefType(map(ctx, pointee.getUnqualifiedType())));
+         } else {
+            return fold_func<RefType>(ctx, ty);
+         }
+      }
       case clang::Type::TypeClass::Vector:
-         // The hope is that this is an aliased type as part of `typedef` / `using`
-         // and the internals don't matter.
-         return new_Type(OpaqueType());
+      case clang::Type::TypeClass::ExtVector: {
+         auto& ty = llvm::cast<clang::VectorType>(type);
+         if (ty.getVectorKind() == clang::VectorType::GenericVector) {
+            return new_Type(VectorType(map(ctx, ty.getElementType()), ty.getNumElements(),
+                                       llvm::isa<clang::ExtVectorType>(ty)));
+         } else {
+            // Target specific vectors (neon, altivec, ...) are distinct from the generic ones in
+            // c++. The hope is that this is an aliased type as part of `typedef` / `using`
+            // and the internals don't matter.
+            return new_Type(OpaqueType());
+         }
+      }
       case clang::Type::TypeClass::ConstantArray: {
          auto& ty = llvm::cast<clang::ConstantArrayType>(type);
          return new_Type(ArrayType(new_Expr(LitExpr(ty.getSize().getLimitedValue())),
@@ -527,29 +748,14 @@ Type map(Context& ctx, const clang::Type& type) {
       case clang::Type::TypeClass::Builtin: return map(ctx, llvm::cast<clang::BuiltinType>(type));
       case clang::Type::TemplateSpecialization: {
          const auto& ty = llvm::cast<clang::TemplateSpecializationType>(type);
-         auto name = ty.getTemplateName();
-         Vec<InstType::Arg> args;
-         for (auto arg : ty.template_arguments()) {
-            switch (arg.getKind()) {
-               case clang::TemplateArgument::Type:
-                  args.emplace_back(map(ctx, arg.getAsType()));
-                  break;
-               case clang::TemplateArgument::Expression:
-                  args.emplace_back(map_expr(ctx, *arg.getAsExpr()));
-                  break;
-               case clang::TemplateArgument::Null:
-               case clang::TemplateArgument::Declaration:
-               case clang::TemplateArgument::NullPtr:
-               case clang::TemplateArgument::Integral:
-               case clang::TemplateArgument::Template:
-               case clang::TemplateArgument::TemplateExpansion:
-               case clang::TemplateArgument::Pack:
-               default:
-                  print(render(arg));
-                  fatal("unhandled inst template argument: ", render(arg.getKind()));
+         // A requested instantiation is bound as a type of its own, see wrap_instantiations.
+         if (auto record = ty.getAsCXXRecordDecl()) {
+            if (auto bound = ctx.lookup(*record)) {
+               return *bound;
             }
          }
-         return new_Type(InstType(inst_name_type(ctx, ty.getTemplateName()), args));
+         return new_Type(InstType(inst_name_type(ctx, ty.getTemplateName()),
+                                  inst_args(ctx, ty.template_arguments())));
       }
       default: print(render(type)); fatal("unhandled mapping: ", type.getTypeClassName());
    }
@@ -558,11 +764,20 @@ Type map(Context& ctx, const clang::Type& type) {
 Param make_param(Context& ctx, const clang::ParmVarDecl& param) {
    auto name = new_Sym(param.getNameAsString());
    auto type = map(ctx, param.getType());
-   if (param.hasDefaultArg()) {
-      return Param(name, type, map_expr(ctx, *param.getDefaultArg()));
-   } else {
-      return Param(name, type);
+   // Default arguments nim cannot express, like calls to constructors, are dropped.
+   if (param.hasDefaultArg() && !param.hasUnparsedDefaultArg() &&
+       !param.hasUninstantiatedDefaultArg()) {
+      if (auto expr = try_map_expr(ctx, *param.getDefaultArg())) {
+         auto canon = param.getType().getCanonicalType();
+         if (!canon->isEnumeralType() && !canon->isAnyCharacterType()) {
+            return Param(name, type, *expr);
+         } else if (is<Sym>(type)) {
+            // The value was folded to an integer.
+            return Param(name, type, new_Expr(ConvExpr(as<Sym>(type), *expr)));
+         }
+      }
    }
+   return Param(name, type);
 }
 
 Params params(Context& ctx, const clang::FunctionDecl& decl) {
@@ -573,9 +788,304 @@ Params params(Context& ctx, const clang::FunctionDecl& decl) {
    return result;
 }
 
+/// Translate the attributes of a routine. `hot`, `cold`, `malloc` and `always_inline` have no nim
+/// counterpart; the backend compiler still sees them in the imported header.
+RoutineAttrs routine_attrs(Context& ctx, const clang::FunctionDecl& decl) {
+   auto no_side_effect = decl.hasAttr<clang::ConstAttr>() || decl.hasAttr<clang::PureAttr>();
+   // Nim requires results to be used by default, which is what `[[nodiscard]]` asks for.
+   auto discardable =
+       ctx.cfg.discardable() && !decl.getReturnType()->isVoidType() && !decl.hasUnusedResultAttr();
+   return RoutineAttrs(is_nothrow(decl), no_side_effect, discardable);
+}
+
+/// The prototype of a function pointer or reference.
+const clang::FunctionProtoType* callback_proto(clang::QualType type) {
+   if (type->isFunctionPointerType() || type->isFunctionReferenceType()) {
+      return type->getPointeeType()->getAs<clang::FunctionProtoType>();
+   } else {
+      return nullptr;
+   }
+}
+
+/// The signature of a `std::function` taken by value or rvalue reference.
+const clang::FunctionProtoType* std_function_proto(clang::QualType type) {
+   auto record =
+       type->isLValueReferenceType() ? nullptr : type.getNonReferenceType()->getAsCXXRecordDecl();
+   if (auto spec = llvm::dyn_cast_or_null<clang::ClassTemplateSpecializationDecl>(record)) {
+      const auto& args = spec->getTemplateArgs();
+      if (spec->isInStdNamespace() && spec->getName() == "function" && args.size() == 1 &&
+          args[0].getKind() == clang::TemplateArgument::Type) {
+         return args[0].getAsType()->getAs<clang::FunctionProtoType>();
+      }
+   }
+   return nullptr;
+}
+
+/// The closure type of a callback, which is its prototype without the parameter at `slot`.
+Type closure_signature(Context& ctx, const clang::FunctionProtoType& proto, Opt<Size> slot) {
+   Vec<Type> types;
+   for (Size i = 0; i < proto.getNumParams(); i += 1) {
+      if (!slot || i != *slot) {
+         types.push_back(map(ctx, proto.getParamType(i)));
+      }
+   }
+   return new_Type(FuncType(types, map_return_type(ctx, proto)));
+}
+
+/// The `void*` parameter of a callback that receives its context.
+Opt<Size> context_slot(const clang::FunctionProtoType& proto) {
+   for (Size i = 0; i < proto.getNumParams(); i += 1) {
+      if (proto.getParamType(i)->isVoidPointerType()) {
+         return i;
+      }
+   }
+   return {};
+}
+
+/// The `void*` parameter of `decl` that is passed back to the callback at `callback`.
+Opt<Size> context_param(const clang::FunctionDecl& decl, Size callback) {
+   for (Size i = 0; i < decl.getNumParams(); i += 1) {
+      if (i != callback && decl.getParamDecl(i)->getType()->isVoidPointerType()) {
+         return i;
+      }
+   }
+   return {};
+}
+
+/// Overload a function or method that takes a callback with one taking a nim closure. The
+/// callback is either a function pointer with a `void*` parameter that receives another `void*`
+/// parameter of the function, or a `std::function`. `self` is the class of a method.
+void wrap_trampoline(Context& ctx, const clang::FunctionDecl& decl, Sym name,
+                     const Params& params, const Opt<Type>& return_type,
+                     const Opt<TemplateParams>& self_template_params = {},
+                     const Opt<Type>& self = {}, bool is_static = false) {
+   for (Size i = 0; i < decl.getNumParams(); i += 1) {
+      auto type = decl.getParamDecl(i)->getType();
+      if (auto proto = callback_proto(type); proto && !proto->isVariadic()) {
+         auto slot = context_slot(*proto);
+         auto context = context_param(decl, i);
+         if (slot && context) {
+            ctx.add(new_RoutineDecl(TrampolineDecl(
+                name, params, return_type, i, context, closure_signature(ctx, *proto, slot),
+                *slot, {}, self_template_params, self, is_static)));
+            return;
+         }
+      } else if (auto function_proto = std_function_proto(type);
+                 function_proto && !function_proto->isVariadic()) {
+         // `ensnare::runtime::ClosureRef` passes the context first.
+         auto function_type = map(ctx, type.getNonReferenceType().getUnqualifiedType());
+         ctx.add(new_RoutineDecl(TrampolineDecl(
+             name, params, return_type, i, {}, closure_signature(ctx, *function_proto, {}), 0,
+             function_type, self_template_params, self, is_static)));
+         return;
+      }
+   }
+}
+
+/// The `std::future` that `type` is a specialization of.
+const clang::ClassTemplateSpecializationDecl* std_future(clang::QualType type) {
+   auto spec =
+       llvm::dyn_cast_or_null<clang::ClassTemplateSpecializationDecl>(type->getAsCXXRecordDecl());
+   if (spec && spec->isInStdNamespace() && spec->getName() == "future" &&
+       spec->getTemplateArgs().size() == 1 &&
+       spec->getTemplateArgs()[0].getKind() == clang::TemplateArgument::Type) {
+      return spec;
+   } else {
+      return nullptr;
+   }
+}
+
+/// Is a callback named like it is called once, when an operation is done.
+bool is_completion_name(const Str& name) {
+   for (auto word : {"done", "complet", "finish"}) {
+      if (name.find(word) != Str::npos) {
+         return true;
+      }
+   }
+   return false;
+}
+
+/// Wrap a function that finishes later with one that returns a nim `Future`. Either it returns a
+/// `std::future`, or it returns nothing and takes a completion callback with a context pointer
+/// and at most one result, which is passed by value.
+void wrap_async(Context& ctx, const clang::FunctionDecl& decl, const FunctionDecl& function) {
+   if (auto future = std_future(decl.getReturnType())) {
+      auto value = future->getTemplateArgs()[0].getAsType();
+      ctx.add(new_RoutineDecl(AsyncDecl(
+          function.name, function.cpp_name, function.header, function.params,
+          value->isVoidType() ? Opt<Type>() : map(ctx, value), *function.return_type)));
+   } else if (decl.getReturnType()->isVoidType()) {
+      for (Size i = 0; i < decl.getNumParams(); i += 1) {
+         const auto& param = *decl.getParamDecl(i);
+         auto proto = callback_proto(param.getType());
+         if (proto && !proto->isVariadic() && proto->getReturnType()->isVoidType() &&
+             proto->getNumParams() <= 2 && is_completion_name(param.getNameAsString())) {
+            auto slot = context_slot(*proto);
+            auto context = context_param(decl, i);
+            if (slot && context) {
+               Opt<Type> value;
+               if (proto->getNumParams() == 2) {
+                  auto type = proto->getParamType(1 - *slot);
+                  if (type->isReferenceType()) {
+                     return;
+                  }
+                  value = map(ctx, type);
+               }
+               ctx.add(new_RoutineDecl(AsyncDecl(function.name, function.cpp_name,
+                                                 function.header, function.params, value, i,
+                                                 *context, *slot)));
+               return;
+            }
+         }
+      }
+   }
+}
+
+bool is_complete_struct(Context& ctx, const clang::CXXRecordDecl& decl);
+
+/// Can a type cross an `extern "C"` thunk. These are the builtin types, plain structs that nim
+/// lays out itself and pointers or references to them. Under `-shims` such a struct is bound as
+/// a plain nim object, so nim includes no header for it either.
+bool is_shim_type(Context& ctx, clang::QualType type) {
+   auto canon = type.getCanonicalType().getNonReferenceType();
+   while (canon->isPointerType()) {
+      canon = canon->getPointeeType();
+   }
+   auto record = canon->getAsCXXRecordDecl();
+   return canon->isBuiltinType() || (record && record->hasDefinition() &&
+                                     record->getDefinition()->isTriviallyCopyable() &&
+                                     is_complete_struct(ctx, *record->getDefinition()));
+}
+
+bool is_shimmable(Context& ctx, const clang::FunctionDecl& decl) {
+   auto method = llvm::dyn_cast<clang::CXXMethodDecl>(&decl);
+   if (decl.isVariadic() || !is_shim_type(ctx, decl.getReturnType()) ||
+       (method && !is_shim_type(ctx, ctx.ast_ctx.getRecordType(method->getParent())))) {
+      return false;
+   }
+   for (auto param : decl.parameters()) {
+      if (!is_shim_type(ctx, param->getType())) {
+         return false;
+      }
+   }
+   return true;
+}
+
+/// How a thunk spells a type. References are passed as pointers, which is how nim passes `var`
+/// parameters, and rvalue references by value, which is how nim passes `sink` parameters.
+Str thunk_type(Context& ctx, clang::QualType type) {
+   auto canon = type.getCanonicalType();
+   auto spelling = canon.getNonReferenceType().getAsString(ctx.ast_ctx.getPrintingPolicy());
+   return canon->isLValueReferenceType() ? spelling + "*" : spelling;
+}
+
+/// Add the `extern "C"` thunk of a function, method or constructor and return its symbol. A
+/// method takes its object as a pointer before the other parameters.
+Str add_thunk(Context& ctx, const clang::FunctionDecl& decl) {
+   Str symbol = "ensnare_";
+   for (auto c : ctx.cfg.output().stem().string()) {
+      symbol += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+   }
+   symbol += "_shim_" + std::to_string(ctx.thunks().size());
+   auto method = llvm::dyn_cast<clang::CXXMethodDecl>(&decl);
+   auto return_type = decl.getReturnType();
+   Str callee = qual_name(decl);
+   Str params;
+   Str args;
+   if (llvm::isa<clang::CXXConstructorDecl>(decl)) {
+      return_type = ctx.ast_ctx.getRecordType(method->getParent());
+      callee = thunk_type(ctx, return_type);
+   } else if (method && !method->isStatic()) {
+      params = thunk_type(ctx, method->getThisType()->getPointeeType()) + "* self";
+      callee = "self->" + decl.getNameAsString();
+   }
+   for (Size i = 0; i < decl.getNumParams(); i += 1) {
+      auto type = decl.getParamDecl(i)->getType();
+      auto name = "a" + std::to_string(i);
+      params += (params.size() == 0 ? "" : ", ") + thunk_type(ctx, type) + " " + name;
+      args += i == 0 ? "" : ", ";
+      if (type->isLValueReferenceType()) {
+         args += "*" + name;
+      } else if (type->isRValueReferenceType()) {
+         auto spelling = type.getCanonicalType().getAsString(ctx.ast_ctx.getPrintingPolicy());
+         args += "static_cast<" + spelling + ">(" + name + ")";
+      } else {
+         args += name;
+      }
+   }
+   Str call = callee + "(" + args + ")";
+   if (return_type->isVoidType()) {
+      call += ";";
+   } else if (return_type->isLValueReferenceType()) {
+      call = "return &" + call + ";";
+   } else {
+      call = "return " + call + ";";
+   }
+   ctx.add_thunk(thunk_type(ctx, return_type) + " " + symbol + "(" + params + ") {\n   " + call +
+                 "\n}\n");
+   return symbol;
+}
+
+/// Is there an overload that nim cannot tell apart from `decl` and that should be bound instead.
+/// That is one taking some of the `const&` parameters of `decl` by rvalue reference, which moves
+/// where `decl` would copy, or one taking some of the reference parameters of `decl` by value,
+/// since C++ cannot pick between `T` and `T&&` for an rvalue and nim not between `T` and a
+/// `{.byref.} T`. The rest must be the same.
+bool has_sink_overload(Context& ctx, const clang::FunctionDecl& decl) {
+   auto method = llvm::dyn_cast<clang::CXXMethodDecl>(&decl);
+   for (auto found : decl.getDeclContext()->getRedeclContext()->lookup(decl.getDeclName())) {
+      auto other = found->getAsFunction();
+      // Overloads that are never bound must not hide this one.
+      if (!other || other == &decl || other->isDeleted() || !ctx.access_guard(*other) ||
+          other->getNumParams() != decl.getNumParams()) {
+         continue;
+      }
+      if (method) {
+         auto other_method = llvm::cast<clang::CXXMethodDecl>(other);
+         if (other_method->isConst() != method->isConst() ||
+             other_method->getRefQualifier() == clang::RQ_RValue) {
+            continue;
+         }
+      }
+      auto sinks = false;
+      auto same = true;
+      for (Size i = 0; i < decl.getNumParams(); i += 1) {
+         auto type = decl.getParamDecl(i)->getType();
+         auto other_type = other->getParamDecl(i)->getType();
+         auto read_only =
+             type->isLValueReferenceType() && type.getNonReferenceType().isConstQualified();
+         auto sink = (read_only && other_type->isRValueReferenceType()) ||
+                     ((read_only || type->isRValueReferenceType()) &&
+                      !other_type->isReferenceType());
+         if (sink && ctx.ast_ctx.hasSameUnqualifiedType(type.getNonReferenceType(),
+                                                        other_type.getNonReferenceType())) {
+            sinks = true;
+         } else if (!ctx.ast_ctx.hasSameUnqualifiedType(type, other_type)) {
+            same = false;
+         }
+      }
+      if (sinks && same) {
+         return true;
+      }
+   }
+   return false;
+}
+
 void wrap_function(Context& ctx, const clang::FunctionDecl& decl) {
-   ctx.add(new_RoutineDecl(FunctionDecl(decl.getNameAsString(), qual_name(decl), ctx.header(decl),
-                                        params(ctx, decl), map_return_type(ctx, decl))));
+   if (has_sink_overload(ctx, decl)) {
+      return;
+   }
+   auto function = FunctionDecl(decl.getNameAsString(), qual_name(decl), ctx.header(decl),
+                                params(ctx, decl), map_return_type(ctx, decl),
+                                routine_attrs(ctx, decl));
+   if (ctx.cfg.shims() && is_shimmable(ctx, decl)) {
+      ctx.add(new_RoutineDecl(ShimDecl(decl.getNameAsString(), add_thunk(ctx, decl),
+                                       function.params, function.return_type, function.attrs)));
+   } else {
+      ctx.add(new_RoutineDecl(function));
+   }
+   wrap_trampoline(ctx, decl, function.name, function.params, function.return_type);
+   wrap_async(ctx, decl, function);
 }
 
 Sym type_sym(Type type) {
@@ -592,9 +1102,13 @@ TemplateParams template_params(Context& ctx, const clang::TemplateDecl& decl) {
 }
 
 void wrap_template_function(Context& ctx, const clang::FunctionDecl& decl) {
+   if (has_sink_overload(ctx, decl)) {
+      return;
+   }
    ctx.add(new_RoutineDecl(FunctionDecl(decl.getNameAsString(), qual_name(decl), ctx.header(decl),
                                         template_params(ctx, *decl.getDescribedFunctionTemplate()),
-                                        params(ctx, decl), map_return_type(ctx, decl))));
+                                        params(ctx, decl), map_return_type(ctx, decl),
+                                        routine_attrs(ctx, decl))));
 }
 
 void wrap_function_base(Context& ctx, const clang::FunctionDecl& decl) {
@@ -622,8 +1136,8 @@ Opt<TemplateParams> self_template_params(Context& ctx, const clang::CXXRecordDec
 
 Str ctor_import_name(Context& ctx, const clang::CXXConstructorDecl& decl) { return "'0"; }
 
-Type self_type(Context& ctx, const clang::CXXMethodDecl& decl) {
-   auto& parent = *decl.getParent();
+/// The type of a class as seen from inside it, instantiated with its own template parameters.
+Type self_type(Context& ctx, const clang::CXXRecordDecl& parent) {
    auto type = map(ctx, parent);
    if (auto templ = parent.getDescribedClassTemplate()) {
       Vec<InstType::Arg> params;
@@ -636,28 +1150,54 @@ Type self_type(Context& ctx, const clang::CXXMethodDecl& decl) {
    }
 }
 
+Type self_type(Context& ctx, const clang::CXXMethodDecl& decl) {
+   return self_type(ctx, *decl.getParent());
+}
+
+/// The receiver of a shimmed method or constructor, see ShimDecl.
+Type shim_self(const clang::CXXMethodDecl& decl, Type self) {
+   if (decl.isStatic() || llvm::isa<clang::CXXConstructorDecl>(decl)) {
+      return new_Type(InstType(new_Type(new_Sym("type", true)), {self}));
+   } else if (decl.isConst()) {
+      return new_Type(ConstRefType(self));
+   } else {
+      return new_Type(RefType(self));
+   }
+}
+
 void wrap_ctor(Context& ctx, const clang::CXXConstructorDecl& decl) {
    // We don't wrap anonymous constructors since they take a supposedly anonymous type as a
    // parameter.
-   if (ctx.access_guard(decl) && has_name(*decl.getParent())) {
-      ctx.add(new_RoutineDecl(ConstructorDecl(ctor_import_name(ctx, decl), ctx.header(decl),
-                                              self_template_params(ctx, *decl.getParent()),
-                                              self_type(ctx, decl), params(ctx, decl))));
+   if (ctx.access_guard(decl) && has_name(*decl.getParent()) && !has_sink_overload(ctx, decl)) {
+      auto ctor = ConstructorDecl(ctor_import_name(ctx, decl), ctx.header(decl),
+                                  self_template_params(ctx, *decl.getParent()),
+                                  self_type(ctx, decl), params(ctx, decl),
+                                  routine_attrs(ctx, decl));
+      if (ctx.cfg.shims() && is_shimmable(ctx, decl)) {
+         ctx.add(new_RoutineDecl(ShimDecl("{}", add_thunk(ctx, decl), shim_self(decl, ctor.self),
+                                          ctor.params, ctor.self, ctor.attrs)));
+      } else {
+         ctx.add(new_RoutineDecl(ctor));
+      }
    }
 }
 
 void wrap_template_ctor(Context& ctx, const clang::CXXConstructorDecl& decl) {
+   if (has_sink_overload(ctx, decl)) {
+      return;
+   }
    ctx.add(new_RoutineDecl(ConstructorDecl(
        ctor_import_name(ctx, decl), ctx.header(decl), self_template_params(ctx, *decl.getParent()),
        self_type(ctx, decl), template_params(ctx, *decl.getDescribedFunctionTemplate()),
-       params(ctx, decl))));
+       params(ctx, decl), routine_attrs(ctx, decl))));
 }
 
 void wrap_ctor_base(Context& ctx, const clang::CXXConstructorDecl& decl) {
    switch (decl.getTemplatedKind()) {
       case clang::FunctionDecl::TK_NonTemplate: wrap_ctor(ctx, decl); break;
       case clang::FunctionDecl::TK_FunctionTemplate: wrap_template_ctor(ctx, decl); break;
-      case clang::FunctionDecl::TK_MemberSpecialization:
+      // A constructor of a requested instantiation, see wrap_instantiations.
+      case clang::FunctionDecl::TK_MemberSpecialization: wrap_ctor(ctx, decl); break;
       case clang::FunctionDecl::TK_FunctionTemplateSpecialization:
       case clang::FunctionDecl::TK_DependentFunctionTemplateSpecialization:
          print(render(decl));
@@ -666,7 +1206,8 @@ void wrap_ctor_base(Context& ctx, const clang::CXXConstructorDecl& decl) {
 }
 
 Str method_import_name(Context& ctx, const clang::CXXMethodDecl& decl) {
-   return (decl.isStatic() ? "'0::" : "#.") + decl.getNameAsString();
+   // The type of a static method's receiver, `'0` would be its result.
+   return (decl.isStatic() ? "'1::" : "#.") + decl.getNameAsString();
 }
 
 Opt<Str> operator_name(const clang::DeclarationName& name) {
@@ -745,22 +1286,38 @@ Str method_name(Context& ctx, const clang::CXXMethodDecl& decl) {
    }
 }
 
+/// Should a method be skipped as an overload of another. A `&&` qualified method needs an
+/// expiring receiver, which the receiver of a nim call never is.
+bool is_shadowed(Context& ctx, const clang::CXXMethodDecl& decl) {
+   return decl.getRefQualifier() == clang::RQ_RValue || has_sink_overload(ctx, decl);
+}
+
 void wrap_method(Context& ctx, const clang::CXXMethodDecl& decl) {
-   if (ctx.access_guard(decl)) {
-      ctx.add(new_RoutineDecl(
+   if (ctx.access_guard(decl) && !is_shadowed(ctx, decl)) {
+      auto method =
           MethodDecl(method_name(ctx, decl), method_import_name(ctx, decl), ctx.header(decl),
                      self_template_params(ctx, *decl.getParent()), self_type(ctx, decl),
-                     params(ctx, decl), map_return_type(ctx, decl), decl.isStatic())));
+                     params(ctx, decl), map_return_type(ctx, decl), decl.isStatic(),
+                     routine_attrs(ctx, decl));
+      if (ctx.cfg.shims() && is_shimmable(ctx, decl)) {
+         ctx.add(new_RoutineDecl(ShimDecl(method_name(ctx, decl), add_thunk(ctx, decl),
+                                          shim_self(decl, method.self), method.params,
+                                          method.return_type, method.attrs)));
+      } else {
+         ctx.add(new_RoutineDecl(method));
+      }
+      wrap_trampoline(ctx, decl, method.name, method.params, method.return_type,
+                      method.self_template_params, method.self, method.is_static);
    }
 }
 
 void wrap_template_method(Context& ctx, const clang::CXXMethodDecl& decl) {
-   if (ctx.access_guard(decl)) {
+   if (ctx.access_guard(decl) && !is_shadowed(ctx, decl)) {
       ctx.add(new_RoutineDecl(
           MethodDecl(method_name(ctx, decl), method_import_name(ctx, decl), ctx.header(decl),
                      self_template_params(ctx, *decl.getParent()), self_type(ctx, decl),
                      template_params(ctx, *decl.getDescribedFunctionTemplate()), params(ctx, decl),
-                     map_return_type(ctx, decl), decl.isStatic())));
+                     map_return_type(ctx, decl), decl.isStatic(), routine_attrs(ctx, decl))));
    }
 }
 
@@ -770,6 +1327,12 @@ void wrap_method_base(Context& ctx, const clang::CXXMethodDecl& decl) {
       case clang::FunctionDecl::TK_NonTemplate: wrap_method(ctx, decl); break;
       case clang::FunctionDecl::TK_FunctionTemplate: wrap_template_method(ctx, decl); break;
       case clang::FunctionDecl::TK_MemberSpecialization:
+         // A member of a requested instantiation, see wrap_instantiations. A deduced return type
+         // is not known until its definition is instantiated.
+         if (!decl.getReturnType()->isUndeducedType()) {
+            wrap_method(ctx, decl);
+         }
+         break;
       case clang::FunctionDecl::TK_FunctionTemplateSpecialization:
       case clang::FunctionDecl::TK_DependentFunctionTemplateSpecialization:
          print(render(decl));
@@ -791,6 +1354,7 @@ void maybe_wrap_method(Context& ctx, const clang::CXXMethodDecl& decl) {
       wrap_conv_base(ctx, *conversion);
    } else if (llvm::isa<clang::CXXDestructorDecl>(decl)) {
       // We don't wrap destructors to make it harder for fools to call them manually.
+      // They are reachable through the `Cpp[T]` hooks, see wrap_hooks.
    } else {
       print(render(decl));
       fatal("unreachable: wrap(CXXRecordDecl::method_range)");
@@ -803,7 +1367,11 @@ void wrap_methods(Context& ctx, const clang::CXXRecordDecl& decl) {
       if (auto method = llvm::dyn_cast<clang::CXXMethodDecl>(child_decl)) {
          maybe_wrap_method(ctx, *method);
       } else if (auto templ = llvm::dyn_cast<clang::FunctionTemplateDecl>(child_decl)) {
-         maybe_wrap_method(ctx, llvm::cast<clang::CXXMethodDecl>(*templ->getTemplatedDecl()));
+         // The member templates of an instantiation, like `std::vector<T>::emplace_back`, would
+         // need instantiations of their own.
+         if (!llvm::isa<clang::ClassTemplateSpecializationDecl>(decl)) {
+            maybe_wrap_method(ctx, llvm::cast<clang::CXXMethodDecl>(*templ->getTemplatedDecl()));
+         }
       } else {
          // do nothing
       }
@@ -816,18 +1384,106 @@ Str qual_nim_name(Context& ctx, const clang::NamedDecl& decl) {
    return replace(qual_name(decl), "::", "-");
 }
 
-Vec<RecordFieldDecl> transfer(Context& ctx, const clang::CXXRecordDecl::field_range fields) {
+/// The alignment requested by `alignas` or `__attribute__((aligned))`, in bytes.
+Opt<U64> explicit_align(Context& ctx, const clang::Decl& decl) {
+   if (auto align = decl.getMaxAlignment()) {
+      return ctx.ast_ctx.toCharUnitsFromBits(align).getQuantity();
+   } else {
+      return {};
+   }
+}
+
+Vec<RecordFieldDecl> transfer(Context& ctx, const clang::CXXRecordDecl& decl) {
    Vec<RecordFieldDecl> result;
-   for (const auto field : fields) {
+   auto layout = has_layout(decl) ? &ctx.ast_ctx.getASTRecordLayout(&decl) : nullptr;
+   for (const auto field : decl.fields()) {
       if (ctx.access_guard(*field)) {
          ctx.push(*field);
-         result.push_back(RecordFieldDecl(field->getNameAsString(), map(ctx, field->getType())));
+         auto name = field->getNameAsString();
+         auto type = map(ctx, field->getType());
+         if (layout) {
+            auto offset = layout->getFieldOffset(field->getFieldIndex());
+            auto align = explicit_align(ctx, *field);
+            // Nim has no alignment pragma for types. Over aligning the first field gives the
+            // same size and alignment.
+            if (field->getFieldIndex() == 0) {
+               if (auto record_align = explicit_align(ctx, decl)) {
+                  align = std::max(align.value_or(0), *record_align);
+               }
+            }
+            result.push_back(RecordFieldDecl(
+                name, type, ctx.ast_ctx.toCharUnitsFromBits(offset).getQuantity(), align));
+         } else {
+            result.push_back(RecordFieldDecl(name, type));
+         }
          ctx.pop_decl();
       }
    }
    return result;
 }
 
+/// Does a field of this type have a binding nim can compute the size and alignment of.
+bool has_nim_layout(Context& ctx, clang::QualType type) {
+   auto canon = type.getCanonicalType();
+   if ((canon.isConstQualified() && !ctx.cfg.ignore_const()) || canon.isVolatileQualified()) {
+      return false; // `CppConst[T]` and `CppVolatile[T]` are imported generics, opaque to nim.
+   } else if (auto builtin = llvm::dyn_cast<clang::BuiltinType>(canon)) {
+      switch (builtin->getKind()) {
+      // These are bound to nim types of a different size or alignment.
+      case clang::BuiltinType::LongDouble:
+      case clang::BuiltinType::Int128:
+      case clang::BuiltinType::UInt128:
+      case clang::BuiltinType::Float128:
+         return false;
+      default:
+         return builtin->isInteger() || builtin->isFloatingPoint() || builtin->isNullPtrType();
+      }
+   } else if (canon->isPointerType()) {
+      return true;
+   } else if (auto array = ctx.ast_ctx.getAsConstantArrayType(canon)) {
+      return has_nim_layout(ctx, array->getElementType());
+   } else if (auto record = canon->getAsCXXRecordDecl()) {
+      return is_complete_struct(ctx, get_definition(*record));
+   } else {
+      return false;
+   }
+}
+
+/// Can nim reproduce the layout of this record from its bound fields. This is the case for a
+/// plain struct with every field bound and every field type laid out the same in nim.
+/// Explicit alignment or packing is fine, but not both since their interaction is subtle.
+bool is_complete_struct(Context& ctx, const clang::CXXRecordDecl& decl) {
+   // Specializations are bound through the generic, which nim cannot lay out.
+   if (!has_layout(decl) || decl.isUnion() || decl.getNumBases() != 0 || decl.isDynamicClass() ||
+       decl.field_empty() || decl.hasAttr<clang::MaxFieldAlignmentAttr>() ||
+       llvm::isa<clang::ClassTemplateSpecializationDecl>(decl)) {
+      return false;
+   }
+   auto packed = decl.hasAttr<clang::PackedAttr>();
+   if (packed && decl.hasAttr<clang::AlignedAttr>()) {
+      return false;
+   }
+   for (const auto field : decl.fields()) {
+      if (!ctx.access_guard(*field) || field->isBitField() ||
+          (packed && field->hasAttr<clang::AlignedAttr>()) ||
+          !has_nim_layout(ctx, field->getType())) {
+         return false;
+      }
+   }
+   return true;
+}
+
+Opt<RecordLayout> record_layout(Context& ctx, const clang::CXXRecordDecl& decl) {
+   if (has_layout(decl)) {
+      const auto& layout = ctx.ast_ctx.getASTRecordLayout(&decl);
+      return RecordLayout(layout.getSize().getQuantity(), layout.getAlignment().getQuantity(),
+                          is_complete_struct(ctx, decl), decl.hasAttr<clang::PackedAttr>(),
+                          ctx.ast_ctx.getTypeSizeInChars(ctx.ast_ctx.VoidPtrTy).getQuantity());
+   } else {
+      return {};
+   }
+}
+
 Sym tag_name(Context& ctx, const clang::NamedDecl& decl) {
    return has_name(decl) ? new_Sym(qual_nim_name(ctx, decl))
                          : new_Sym("type_of(" + qual_nim_name(ctx, ctx.decl(1)) + ")");
@@ -859,17 +1515,151 @@ Sym register_templ_record_name(Context& ctx, const clang::NamedDecl& name_decl,
 }
 
 Str tag_import_name(Context& ctx, const clang::NamedDecl& decl) {
-   return has_name(decl) ? decl.getQualifiedNameAsString()
-                         : "decltype(" + ctx.decl(1).getQualifiedNameAsString() + ")";
+   if (llvm::isa<clang::ClassTemplateSpecializationDecl>(decl)) {
+      // Spelled with all its arguments, including the defaulted ones.
+      Str result;
+      llvm::raw_string_ostream stream(result);
+      decl.getNameForDiagnostics(stream, ctx.ast_ctx.getPrintingPolicy(), true);
+      return stream.str();
+   } else {
+      return has_name(decl) ? decl.getQualifiedNameAsString()
+                            : "decltype(" + ctx.decl(1).getQualifiedNameAsString() + ")";
+   }
+}
+
+/// Bind the lifetime hooks of the managed `Cpp[T]` wrapper to the special members of a class.
+/// Trivially copyable classes are bound as plain nim value types instead and need none.
+void wrap_hooks(Context& ctx, const clang::NamedDecl& name_decl,
+                const clang::CXXRecordDecl& def_decl, Sym name) {
+   if (has_name(name_decl) && !def_decl.isTriviallyCopyable()) {
+      auto copyable = has_copy_ctor(def_decl);
+      // Moving falls back to copying when there is no move constructor, just like `std::move`.
+      auto movable = copyable || has_move_ctor(def_decl);
+      ctx.add(new_RoutineDecl(HooksDecl(tag_import_name(ctx, name_decl), ctx.header(name_decl),
+                                        new_Type(name), has_dtor(def_decl), copyable, movable)));
+   }
+}
+
+/// The public, non-static method `name` without parameters, preferring a non-const overload.
+OptRef<const clang::CXXMethodDecl> nullary_method(Context& ctx, const clang::CXXRecordDecl& decl,
+                                                  llvm::StringRef name) {
+   const clang::CXXMethodDecl* result = nullptr;
+   for (auto method : decl.methods()) {
+      if (ctx.access_guard(*method) && !method->isStatic() && method->getNumParams() == 0 &&
+          method->getIdentifier() && method->getName() == name && (!result || result->isConst())) {
+         result = method;
+      }
+   }
+   if (result) {
+      return *result;
+   } else {
+      return {};
+   }
+}
+
+/// Does the class have a public `(T*, size)` constructor, like `std::string_view`.
+bool has_pointer_ctor(Context& ctx, const clang::CXXRecordDecl& decl, clang::QualType element) {
+   for (auto ctor : decl.ctors()) {
+      if (ctx.access_guard(*ctor) && ctor->getNumParams() == 2) {
+         auto data = ctor->getParamDecl(0)->getType();
+         auto size = ctor->getParamDecl(1)->getType();
+         if (data->isPointerType() && !size->isPointerType() &&
+             ctx.ast_ctx.hasSameUnqualifiedType(data->getPointeeType(), element)) {
+            return true;
+         }
+      }
+   }
+   return false;
+}
+
+/// Bind `openArray` views for a class with `T* data()` and `size()` members. Those are the
+/// members `std::data` and `std::size` use, so the views work through them.
+void wrap_views(Context& ctx, const clang::NamedDecl& name_decl,
+                const clang::CXXRecordDecl& def_decl) {
+   auto data = nullary_method(ctx, def_decl, "data");
+   auto size = nullary_method(ctx, def_decl, "size");
+   if (has_name(name_decl) && data && size && data->get().getReturnType()->isPointerType() &&
+       !size->get().getReturnType()->isVoidType()) {
+      auto element = data->get().getReturnType()->getPointeeType().getUnqualifiedType();
+      if (!element->isVoidType()) {
+         ctx.add(new_RoutineDecl(ViewDecl(ctx.header(name_decl),
+                                          self_template_params(ctx, def_decl),
+                                          self_type(ctx, def_decl), map(ctx, element),
+                                          has_pointer_ctor(ctx, def_decl, element))));
+      }
+   }
+}
+
+/// The public operator `op` of a class without parameters, preferring a non-const overload.
+OptRef<const clang::CXXMethodDecl> nullary_operator(Context& ctx, const clang::CXXRecordDecl& decl,
+                                                    clang::OverloadedOperatorKind op) {
+   const clang::CXXMethodDecl* result = nullptr;
+   for (auto method : decl.methods()) {
+      if (ctx.access_guard(*method) && method->getOverloadedOperator() == op &&
+          method->getNumParams() == 0 && (!result || result->isConst())) {
+         result = method;
+      }
+   }
+   if (result) {
+      return *result;
+   } else {
+      return {};
+   }
+}
+
+/// What dereferencing an iterator yields. It is a pointer or a class with a prefix `operator++`
+/// and `operator*`. `operator!=` is usually a free function, so it is left to the c++ compiler.
+Opt<clang::QualType> deref_type(Context& ctx, clang::QualType iterator) {
+   if (iterator->isPointerType()) {
+      return ctx.ast_ctx.getLValueReferenceType(iterator->getPointeeType());
+   } else if (auto record = iterator->getAsCXXRecordDecl()) {
+      auto deref = nullary_operator(ctx, *record, clang::OO_Star);
+      if (deref && nullary_operator(ctx, *record, clang::OO_PlusPlus)) {
+         return deref->get().getReturnType();
+      }
+   }
+   return {};
+}
+
+/// Bind `items`, `mitems` and `pairs` for a class with `begin()` and `end()` members. Iterator
+/// types that depend on template parameters cannot be inspected, so those are skipped.
+void wrap_iterators(Context& ctx, const clang::NamedDecl& name_decl,
+                    const clang::CXXRecordDecl& def_decl) {
+   auto begin = nullary_method(ctx, def_decl, "begin");
+   auto end = nullary_method(ctx, def_decl, "end");
+   if (!has_name(name_decl) || !begin || !end) {
+      return;
+   }
+   auto iterator = begin->get().getReturnType();
+   if (iterator->isDependentType() ||
+       !ctx.ast_ctx.hasSameUnqualifiedType(iterator, end->get().getReturnType())) {
+      return;
+   }
+   if (auto deref = deref_type(ctx, iterator)) {
+      auto by_ref = (*deref)->isLValueReferenceType();
+      auto element = deref->getNonReferenceType();
+      if (!element->isDependentType() && !element->isVoidType()) {
+         ctx.add(new_RoutineDecl(IteratorDecl(
+             self_template_params(ctx, def_decl), self_type(ctx, def_decl),
+             map(ctx, iterator.getUnqualifiedType()), map(ctx, element.getUnqualifiedType()),
+             by_ref, by_ref && !element.isConstQualified())));
+      }
+   }
 }
 
 void wrap_record_non_template(Context& ctx, const clang::NamedDecl& name_decl,
                               const clang::CXXRecordDecl& def_decl, bool force) {
-   ctx.add(new_TypeDecl(RecordTypeDecl(register_tag_name(ctx, name_decl, def_decl),
-                                       tag_import_name(ctx, name_decl), ctx.header(name_decl),
-                                       transfer(ctx, def_decl.fields()))));
+   auto name = register_tag_name(ctx, name_decl, def_decl);
+   auto plain = ctx.cfg.shims() && is_shim_type(ctx, ctx.ast_ctx.getRecordType(&def_decl));
+   ctx.add(new_TypeDecl(RecordTypeDecl(name, tag_import_name(ctx, name_decl),
+                                       ctx.header(name_decl), transfer(ctx, def_decl),
+                                       def_decl.isTriviallyCopyable(),
+                                       record_layout(ctx, def_decl), plain)));
+   wrap_hooks(ctx, name_decl, def_decl, name);
    if (!force) {
       wrap_methods(ctx, def_decl);
+      wrap_views(ctx, name_decl, def_decl);
+      wrap_iterators(ctx, name_decl, def_decl);
    }
 }
 
@@ -891,9 +1681,11 @@ void wrap_record_template(Context& ctx, const clang::NamedDecl& name_decl,
    ctx.add(new_TypeDecl(
        RecordTypeDecl(register_templ_record_name(ctx, name_decl, def_decl, templ_def_decl),
                       template_record_import_name(ctx, templ_def_decl), ctx.header(name_decl),
-                      template_params(ctx, templ_def_decl), transfer(ctx, def_decl.fields()))));
+                      template_params(ctx, templ_def_decl), transfer(ctx, def_decl))));
    if (!force) {
       wrap_methods(ctx, def_decl);
+      wrap_views(ctx, name_decl, def_decl);
+      wrap_iterators(ctx, name_decl, def_decl);
    }
 }
 
@@ -908,6 +1700,23 @@ void wrap_record(Context& ctx, const clang::NamedDecl& name_decl,
    }
 }
 
+/// Are the nonzero fields distinct powers of two that include the first bit. Nim sets index their
+/// bits from the lowest element, so this is what lets a set share the representation.
+bool is_flag_enum(const Vec<EnumFieldDecl>& fields) {
+   U64 seen = 0;
+   auto count = 0;
+   for (const auto& field : fields) {
+      auto val = *field.val;
+      if (val < 0 || (val & (val - 1)) != 0 || (seen & U64(val)) != 0) {
+         return false;
+      } else if (val != 0) {
+         seen |= U64(val);
+         count += 1;
+      }
+   }
+   return count >= 2 && (seen & 1) != 0;
+}
+
 void wrap_enum(Context& ctx, const clang::NamedDecl& name_decl, const clang::EnumDecl& def_decl,
                bool force) {
    if (has_name(name_decl) || force) {
@@ -921,9 +1730,14 @@ void wrap_enum(Context& ctx, const clang::NamedDecl& name_decl, const clang::Enu
          fields.push_back(
              EnumFieldDecl(new_Sym(field->getNameAsString()), field->getInitVal().getExtValue()));
       }
+      // A forward declaration without a fixed type has no underlying type yet.
+      Opt<U64> size;
+      if (!def_decl.getIntegerType().isNull()) {
+         size = ctx.ast_ctx.getTypeSizeInChars(def_decl.getIntegerType()).getQuantity();
+      }
       ctx.add(new_TypeDecl(EnumTypeDecl(register_tag_name(ctx, name_decl, def_decl),
                                         tag_import_name(ctx, name_decl), ctx.header(name_decl),
-                                        fields)));
+                                        fields, size, is_flag_enum(fields))));
    }
 }
 
@@ -1030,6 +1844,58 @@ void wrap_typedef(Context& ctx, const clang::TypedefDecl& decl) {
    }
 }
 
+/// A pointer to the start of a narrow string literal.
+OptRef<const clang::StringLiteral> string_literal(const clang::APValue& value) {
+   if (value.isLValue() && value.getLValueOffset().isZero()) {
+      if (auto expr = value.getLValueBase().dyn_cast<const clang::Expr*>()) {
+         auto literal = llvm::dyn_cast<clang::StringLiteral>(expr);
+         if (literal && (literal->isAscii() || literal->isUTF8())) {
+            return *literal;
+         }
+      }
+   }
+   return {};
+}
+
+/// Evaluate the initializer of a constant variable to a literal nim can fold at compile time.
+/// Arithmetic values of builtin types and pointers to string literals are supported. Character
+/// types are left alone since nim does not convert integer literals to `char`.
+Opt<ConstantDecl> fold_constant(Context& ctx, const clang::VarDecl& decl) {
+   auto type = decl.getType();
+   auto canon = type.getCanonicalType();
+   if (!(decl.isConstexpr() || type.isConstQualified()) || !decl.getInit() ||
+       decl.getInit()->isValueDependent() || decl.getDeclContext()->isDependentContext()) {
+      return {};
+   }
+   auto value = decl.evaluateValue();
+   if (!value) {
+      return {};
+   }
+   auto name = qual_nim_name(ctx, decl);
+   if (canon->isBuiltinType() && !canon->isAnyCharacterType()) {
+      if (auto folded = fold_value(*value, canon)) {
+         return new_ConstantDecl(name, map(ctx, type.getUnqualifiedType()), *folded);
+      }
+   } else if (canon->isPointerType() && canon->getPointeeType()->isCharType()) {
+      if (auto literal = string_literal(*value)) {
+         return new_ConstantDecl(name, new_Type(new_Sym("cstring")),
+                                 new_Expr(LitExpr<Str>(literal->get().getString().str())));
+      }
+   }
+   return {};
+}
+
+void wrap_variable(Context& ctx, const clang::VarDecl& decl) {
+   if (ctx.access_guard(decl) && decl.hasGlobalStorage() && !decl.isStaticLocal()) {
+      if (auto constant = fold_constant(ctx, decl)) {
+         ctx.add(*constant);
+      } else {
+         ctx.add(new_VariableDecl(qual_nim_name(ctx, decl), qual_name(decl), ctx.header(decl),
+                                  map(ctx, decl.getType())));
+      }
+   }
+}
+
 /// For every type with a name we must produce an accessible type declartion for nim.
 /// This forces binding declarations of types we did not previously bind.
 /// It is called during mapping.
@@ -1054,6 +1920,7 @@ void force_wrap(Context& ctx, const clang::NamedDecl& named_decl) {
                 ctx,
                 get_definition(llvm::cast<clang::ClassTemplateDecl>(named_decl).getTemplatedDecl()),
                 true);
+            break;
          default:
             write(render(named_decl));
             fatal("unhandled force_wrap: ", named_decl.getDeclKindName(), "Decl");
@@ -1082,14 +1949,9 @@ void wrap(Context& ctx, const clang::NamedDecl& named_decl) {
          case clang::Decl::Kind::Function:
             wrap_function_base(ctx, llvm::cast<clang::FunctionDecl>(named_decl));
             break;
-         case clang::Decl::Kind::Var: {
-            auto& decl = llvm::cast<clang::VarDecl>(named_decl);
-            if (ctx.access_guard(decl) && decl.hasGlobalStorage() && !decl.isStaticLocal()) {
-               ctx.add(new_VariableDecl(qual_nim_name(ctx, decl), qual_name(decl), ctx.header(decl),
-                                        map(ctx, decl.getType())));
-            }
+         case clang::Decl::Kind::Var:
+            wrap_variable(ctx, llvm::cast<clang::VarDecl>(named_decl));
             break;
-         }
          case clang::Decl::Kind::ObjCIvar:
          case clang::Decl::Kind::ObjCAtDefsField: fatal("obj-c not supported");
          case clang::Decl::Kind::Namespace: // FIXME: doing something with this would be good.
@@ -1105,6 +1967,8 @@ void wrap(Context& ctx, const clang::NamedDecl& named_decl) {
          case clang::Decl::Kind::CXXConstructor:
          case clang::Decl::Kind::CXXDestructor:
          case clang::Decl::Kind::ClassTemplate:
+         case clang::Decl::Kind::ClassTemplateSpecialization: // see wrap_instantiations
+         case clang::Decl::Kind::ClassTemplatePartialSpecialization:
          case clang::Decl::Kind::FunctionTemplate: break; // discarded
          default:
             write(render(named_decl));
@@ -1147,6 +2011,74 @@ void base_wrap(Context& ctx, const clang::Decl& decl) {
    }
 }
 
+/// The nim name of a requested instantiation, `std::vector<int>` is `std-vector_int`.
+Str instance_nim_name(const Str& spelling) {
+   Str result;
+   for (Size i = 0; i < spelling.size(); i += 1) {
+      if (std::isalnum(static_cast<unsigned char>(spelling[i])) || spelling[i] == '_') {
+         result += spelling[i];
+      } else if (spelling.compare(i, 2, "::") == 0) {
+         result += result.size() == 0 ? "" : "-";
+         i += 1;
+      } else if (result.size() != 0 && result.back() != '_' && result.back() != '-') {
+         result += '_';
+      }
+   }
+   while (result.size() != 0 && result.back() == '_') {
+      result.pop_back();
+   }
+   return result;
+}
+
+/// Bind a requested instantiation as a concrete type. Its members are bound from their
+/// instantiated declarations, so they are plain procs of the fully spelled c++ type, not
+/// generics nim has to instantiate again at every use.
+void wrap_instantiation(Context& ctx, const Str& spelling,
+                        const clang::ClassTemplateSpecializationDecl& decl) {
+   auto name = new_Sym(instance_nim_name(spelling));
+   ctx.associate(decl, new_Type(name));
+   ctx.push(decl);
+   ctx.add(new_TypeDecl(RecordTypeDecl(name, tag_import_name(ctx, decl), ctx.header(decl),
+                                       transfer(ctx, decl), decl.isTriviallyCopyable(),
+                                       record_layout(ctx, decl))));
+   wrap_hooks(ctx, decl, decl, name);
+   wrap_methods(ctx, decl);
+   wrap_views(ctx, decl, decl);
+   wrap_iterators(ctx, decl, decl);
+   ctx.pop_decl();
+}
+
+/// Find the `ensnare_instance_<i>` aliases that parse_translation_unit declares for each
+/// instantiation and bind what they name.
+void wrap_instantiations(Context& ctx) {
+   const auto& instantiations = ctx.cfg.instantiations();
+   for (auto decl : ctx.ast_ctx.getTranslationUnitDecl()->decls()) {
+      auto alias = llvm::dyn_cast<clang::TypeAliasDecl>(decl);
+      for (Size i = 0; alias && i < instantiations.size(); i += 1) {
+         if (alias->getName() == "ensnare_instance_" + std::to_string(i)) {
+            auto record = alias->getUnderlyingType()->getAsCXXRecordDecl();
+            auto spec = llvm::dyn_cast_or_null<clang::ClassTemplateSpecializationDecl>(record);
+            if (spec && spec->hasDefinition()) {
+               wrap_instantiation(ctx, instantiations[i], *spec);
+            } else {
+               fatal("not a class template instantiation: ", instantiations[i]);
+            }
+         }
+      }
+   }
+}
+
+/// Bind the object-like macros of bindable headers that evaluate to a constant.
+void wrap_macros(Context& ctx, clang::Preprocessor& pp) {
+   for (const auto& [ident, info] : object_macros(pp)) {
+      if (ctx.maybe_header(info->getDefinitionLoc())) {
+         if (auto value = eval_macro(pp, *info)) {
+            ctx.add(new_ConstantDecl(ident->getName().str(), *value));
+         }
+      }
+   }
+}
+
 /// Procduce system search path arguments
 Vec<Str> prefixed_search_paths() {
    Vec<Str> result;
@@ -1156,9 +2088,8 @@ Vec<Str> prefixed_search_paths() {
    return result;
 }
 
-/// Load a translation unit from user provided arguments with additional include path
-/// arguments.
-std::unique_ptr<clang::ASTUnit> parse_translation_unit(const Config& cfg) {
+/// The arguments clang parses the bound headers with.
+Vec<Str> clang_args(const Config& cfg) {
    // We target c++ and we mimic nim's semantics of default unsigned chars.
    Vec<Str> args = {"-xc++", "-funsigned-char"};
    auto search_paths = prefixed_search_paths();
@@ -1168,7 +2099,21 @@ std::unique_ptr<clang::ASTUnit> parse_translation_unit(const Config& cfg) {
    }
    // The users args get placed after for higher priority.
    args.insert(args.end(), cfg.user_clang_args().begin(), cfg.user_clang_args().end());
-   return clang::tooling::buildASTFromCodeWithArgs(cfg.header_file(), args, "ensnare_headers.hpp",
+   return args;
+}
+
+/// Load a translation unit from user provided arguments with additional include path
+/// arguments.
+std::unique_ptr<clang::ASTUnit> parse_translation_unit(const Config& cfg) {
+   // Instantiations are declared `extern` so clang instantiates every member declaration, and
+   // named by an alias so wrap_instantiations can find them.
+   auto code = cfg.header_file();
+   for (Size i = 0; i < cfg.instantiations().size(); i += 1) {
+      code += "extern template class " + cfg.instantiations()[i] + ";\n";
+      code += "using ensnare_instance_" + std::to_string(i) + " = " + cfg.instantiations()[i] +
+              ";\n";
+   }
+   return clang::tooling::buildASTFromCodeWithArgs(code, clang_args(cfg), "ensnare_headers.hpp",
                                                    "ensnare");
 }
 
@@ -1185,18 +2130,113 @@ void post_process(Context& ctx) {
    }
 }
 
+/// Write the umbrella header next to the bindings. Every header pragma of the bindings names
+/// it, so the nim backend includes one header, which can be precompiled.
+void write_umbrella(const Config& cfg, const Path& dir) {
+   Str header = "#pragma once\n\n" + cfg.header_file();
+   for (const auto& instantiation : cfg.instantiations()) {
+      header += "extern template class " + instantiation + ";\n";
+   }
+   auto path = dir / cfg.umbrella_header();
+   require(write_file(path, header), "failed to write umbrella header: ", path);
+}
+
+/// Precompile the umbrella header with the arguments the bound headers were parsed with, and
+/// the language options of the backend's default build, see `cpp_pch_usable`. Clang rejects a
+/// precompiled header when either differs.
+void write_pch(const Config& cfg, const Path& dir) {
+   auto header = dir / cfg.umbrella_header();
+   auto pch = Path(header).concat(".pch");
+   Vec<Str> args = {"clang"};
+   for (const auto& arg : clang_args(cfg)) {
+      if (arg == "-xc++") {
+         args.insert(args.end(), {"-xc++-header", "-std=c++17"});
+      } else {
+         args.push_back(arg);
+      }
+   }
+   args.insert(args.end(), {header.string(), "-o", pch.string()});
+   llvm::IntrusiveRefCntPtr<clang::FileManager> files(
+       new clang::FileManager(clang::FileSystemOptions()));
+   clang::tooling::ToolInvocation invocation(args, std::make_unique<clang::GeneratePCHAction>(),
+                                             files.get());
+   require(invocation.run(), "failed to precompile umbrella header: ", header);
+}
+
+/// Write the companion translation unit of `-instantiate` next to the bindings. The umbrella
+/// header declares each instantiation `extern` so that only this source defines it.
+void write_instances(const Config& cfg, const Path& dir) {
+   Str source = "#include \"" + cfg.umbrella_header() + "\"\n\n";
+   for (const auto& instantiation : cfg.instantiations()) {
+      source += "template class " + instantiation + ";\n";
+   }
+   auto path = dir / cfg.instances_source();
+   require(write_file(path, source), "failed to write instances source: ", path);
+}
+
+/// Bindings find their umbrella header next to them.
+Str render_umbrella(const Config& cfg) {
+   Str result = "from std/os import parent_dir, quote_shell, `/`\n"
+                "{.pass_c: \"-I\" & quote_shell(current_source_path().parent_dir).}\n";
+   if (cfg.pch()) {
+      // A backend that cannot use it includes the umbrella header itself.
+      auto pch = "current_source_path().parent_dir / \"" + cfg.umbrella_header() + ".pch\"";
+      result += "when cpp_pch_usable(" + pch + "):\n   {.pass_c: \"-include-pch \" & quote_shell(" +
+                pch + ").}\n";
+   }
+   if (cfg.instantiations().size() != 0) {
+      result += "{.compile: \"" + cfg.instances_source() + "\".}\n";
+   }
+   return result;
+}
+
+/// Write the `extern "C"` thunks of `-shims` next to the bindings. This is the one translation
+/// unit that includes the bound headers for them.
+void write_shims(const Context& ctx, const Path& dir) {
+   Str source = ctx.cfg.header_file() + "\nextern \"C\" {\n";
+   for (const auto& thunk : ctx.thunks()) {
+      source += "\n" + thunk;
+   }
+   auto path = dir / ctx.cfg.shims_source();
+   require(write_file(path, source + "}\n"), "failed to write shims source: ", path);
+}
+
 /// Entrypoint to the c++ part of ensnare.
 void run(int argc, const char* argv[]) {
    const Config cfg(argc, argv);
    auto translation_unit = parse_translation_unit(cfg);
    Context ctx(cfg, translation_unit->getASTContext());
+   wrap_instantiations(ctx);
    if (visit(*translation_unit, ctx, base_wrap)) {
+      wrap_macros(ctx, translation_unit->getPreprocessor());
       post_process(ctx);
+      auto path = Path(cfg.output()).replace_extension(".nim");
       Str output = "import ensnare/runtime\nexport runtime\n";
+      for (const auto& routine_decl : ctx.routine_decls()) {
+         if (is<AsyncDecl>(*routine_decl)) {
+            output += "import ensnare/cpp_async\nexport cpp_async\n";
+            break;
+         }
+      }
+      if (cfg.umbrella()) {
+         write_umbrella(cfg, path.parent_path());
+         if (cfg.pch()) {
+            write_pch(cfg, path.parent_path());
+         }
+         if (cfg.instantiations().size() != 0) {
+            write_instances(cfg, path.parent_path());
+         }
+         output += render_umbrella(cfg);
+      }
+      if (ctx.thunks().size() != 0) {
+         write_shims(ctx, path.parent_path());
+         output += "{.compile: \"" + cfg.shims_source() + "\".}\n";
+      }
+      // Constants may have a declared type, like a typedef of a builtin.
       output += render(ctx.type_decls());
+      output += render(ctx.constant_decls());
       output += render(ctx.routine_decls());
       output += render(ctx.variable_decls());
-      auto path = Path(cfg.output()).replace_extension(".nim");
       require(write_file(path, output), "failed to write output file: ", path);
    } else {
       fatal("failed to execute visitor");
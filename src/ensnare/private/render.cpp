@@ -3,12 +3,14 @@
 // Producing template functions:
 // Nim's import_cpp patterns can only reference concrete parameters not template arguments,
 // which is what we really want. Fixing this isn't trivial. I tried.
-// This only matters for template parameters which cannot be inferred from arguments.
-// Instead we (ab)use typedesc parameters which are considered parameters. Consider:
+// This only matters for template parameters which cannot be inferred from arguments, c++
+// deduces the rest just like nim infers them. For those we (ab)use typedesc parameters, which
+// are considered parameters, and forward to them with a nim template. Consider:
 // template <typename T> T init(int n);
 // For which we produce:
-// proc init_internal[T](n: int, �: type[T]) {.import_cpp: "init<'1>(@)".}
-// proc init*[T](n: int) = init_internal(n, T)
+// proc init_internal[T](n: CppInt, �2: type[T]): T {.import_cpp: "init<'2>(@)".}
+// template init*[T](n: CppInt): T = init_internal(n, T)
+// Nim callers pass the template arguments like generic ones: `init[float](1)`.
 
 #include "ensnare/private/render.hpp"
 
@@ -16,7 +18,12 @@
 
 #include "llvm/ADT/StringSet.h"
 
+#include <cmath>
 #include <cstdint>
+#include <cstdio>
+#include <iomanip>
+#include <limits>
+#include <sstream>
 
 namespace ensnare {
 using std::to_string;
@@ -87,13 +94,69 @@ Str render(const Sym sym) {
    }
 }
 
+Str render_uint_lit(U64 value) {
+   // Without a suffix nim reads an integer literal as an `int64`.
+   return to_string(value) + (value > U64(std::numeric_limits<I64>::max()) ? "'u64" : "");
+}
+
+Str render_float_lit(F64 value) {
+   if (std::isnan(value)) {
+      return "NaN";
+   } else if (std::isinf(value)) {
+      return value < 0 ? "-Inf" : "Inf";
+   } else {
+      std::ostringstream result;
+      result << std::setprecision(std::numeric_limits<F64>::max_digits10) << value;
+      auto str = result.str();
+      // Keep it a float literal.
+      return str.find_first_of(".e") == Str::npos ? str + ".0" : str;
+   }
+}
+
+Str render_str_lit(const Str& str) {
+   Str result = "\"";
+   for (unsigned char c : str) {
+      switch (c) {
+         case '"': result += "\\\""; break;
+         case '\\': result += "\\\\"; break;
+         case '\n': result += "\\n"; break;
+         case '\t': result += "\\t"; break;
+         default:
+            if (c < 0x20 || c >= 0x7f) {
+               char escaped[5];
+               std::snprintf(escaped, sizeof(escaped), "\\x%02X", c);
+               result += escaped;
+            } else {
+               result += c;
+            }
+      }
+   }
+   return result + "\"";
+}
+
 Str render(Expr expr) {
    if (is<LitExpr<U64>>(expr)) {
-      return to_string(as<LitExpr<U64>>(expr).value);
+      return render_uint_lit(as<LitExpr<U64>>(expr).value);
    } else if (is<LitExpr<I64>>(expr)) {
       return to_string(as<LitExpr<I64>>(expr).value);
+   } else if (is<LitExpr<F64>>(expr)) {
+      return render_float_lit(as<LitExpr<F64>>(expr).value);
+   } else if (is<LitExpr<bool>>(expr)) {
+      return as<LitExpr<bool>>(expr).value ? "true" : "false";
+   } else if (is<LitExpr<Str>>(expr)) {
+      return render_str_lit(as<LitExpr<Str>>(expr).value);
    } else if (is<ConstParamExpr>(expr)) {
       return render(as<ConstParamExpr>(expr).name);
+   } else if (is<BinaryExpr>(expr)) {
+      // Nim and c++ precedence differ, so always parenthesize.
+      const auto& binary = as<BinaryExpr>(expr);
+      return "(" + render(binary.lhs) + " " + binary.op + " " + render(binary.rhs) + ")";
+   } else if (is<UnaryExpr>(expr)) {
+      const auto& unary = as<UnaryExpr>(expr);
+      return "(" + unary.op + (unary.op == "not" ? " " : "") + render(unary.operand) + ")";
+   } else if (is<ConvExpr>(expr)) {
+      const auto& conv = as<ConvExpr>(expr);
+      return render(conv.type) + "(" + render(conv.operand) + ")";
    } else {
       fatal("unhandled expr");
    }
@@ -103,6 +166,10 @@ Str render(const PtrType& type) { return "ptr " + render(type.pointee); }
 
 Str render(const RefType& type) { return "var " + render(type.pointee); }
 
+Str render(const RValueRefType& type) { return "sink " + render(type.pointee); }
+
+Str render(const ConstRefType& type) { return "var CppConst[" + render(type.pointee) + "]"; }
+
 Str render(const OpaqueType& type) { return "object"; }
 
 Str render(const InstType::Arg& arg) { return visit(LAMBDA(render), arg); }
@@ -140,11 +207,21 @@ Str render(const FuncType& type) {
    if (type.return_type) {
       result += ": " + render(*type.return_type);
    }
-   return result;
+   // Nim proc types are closures by default, c function pointers are plain `cdecl` procs.
+   return result + " {.cdecl.}";
 }
 
 Str render(const ConstType& type) { return "CppConst[" + render(type.type) + "]"; }
 
+Str render(const VolatileType& type) { return "CppVolatile[" + render(type.type) + "]"; }
+
+Str render(const RestrictType& type) { return render(type.type); }
+
+Str render(const VectorType& type) {
+   return (type.ext ? "CppExtVector[" : "CppVector[") + render(type.element) + ", " +
+          to_string(type.lanes) + "]";
+}
+
 Str render(Type type) { return visit(LAMBDA(render), *type); }
 
 Str render_pragmas(const Vec<Str>& pragmas) {
@@ -177,17 +254,46 @@ Str render(const EnumFieldDecl& decl) {
    }
 }
 
+Sym flag_sym(const EnumTypeDecl& decl) { return new_Sym(decl.name->latest() + "_flag"); }
+
+Sym flags_sym(const EnumTypeDecl& decl) { return new_Sym(decl.name->latest() + "_flags"); }
+
+/// The bits of a flag enum as a pure enum ordered by bit, and the set of them.
+Str render_flags(const EnumTypeDecl& decl) {
+   Str result = render(flag_sym(decl)) + "* " + render_pragmas({"pure"}) + " = enum\n";
+   for (const auto& field : decl.fields) {
+      if (*field.val != 0) {
+         auto bit = 0;
+         while ((U64(*field.val) >> bit) != 1) {
+            bit += 1;
+         }
+         result += render(EnumFieldDecl(field.name, bit));
+      }
+   }
+   return result + render(flags_sym(decl)) + "* = set[" + render(flag_sym(decl)) + "]\n";
+}
+
 Str render(const EnumTypeDecl& decl) {
-   Str result = render(decl.name) + "* " +
-                render_pragmas({import_cpp(decl.cpp_name), header(decl.header)}) + " = enum\n";
+   Vec<Str> pragmas = {import_cpp(decl.cpp_name), header(decl.header)};
+   if (decl.size) {
+      pragmas.push_back("size: " + to_string(*decl.size));
+   }
+   Str result = render(decl.name) + "* " + render_pragmas(pragmas) + " = enum\n";
    for (const auto& field : decl.fields) {
       result += render(field);
    }
+   if (decl.flags) {
+      result += render_flags(decl);
+   }
    return result;
 }
 
 Str render(const RecordFieldDecl& decl) {
-   return indent() + render(decl.name) + ": " + render(decl.type) + '\n';
+   Str result = indent() + render(decl.name);
+   if (decl.align) {
+      result += " " + render_pragmas({"align: " + to_string(*decl.align)});
+   }
+   return result + ": " + render(decl.type) + '\n';
 }
 
 Str render(const TemplateParam& param) {
@@ -229,7 +335,20 @@ Str render(const RecordTypeDecl& decl) {
    if (auto template_params = render(decl.template_params)) {
       result += render_template_params(*template_params) + " ";
    }
-   result += render_pragmas({import_cpp(decl.cpp_name), header(decl.header)}) + " = object\n";
+   Vec<Str> pragmas;
+   if (!decl.plain) {
+      pragmas = {import_cpp(decl.cpp_name), header(decl.header)};
+   }
+   if (decl.trivially_copyable) {
+      pragmas.push_back("bycopy");
+   }
+   if (!decl.plain && decl.layout && decl.layout->complete) {
+      pragmas.push_back("complete_struct");
+   }
+   if (decl.layout && decl.layout->packed) {
+      pragmas.push_back("packed");
+   }
+   result += render_pragmas(pragmas) + " = object\n";
    for (const auto& field : decl.fields) {
       result += render(field);
    }
@@ -244,15 +363,21 @@ template <typename T> Param type_self_param(const T& decl) {
    return Param(anon_sym, typedesc(decl.self));
 }
 
-Str render(const Param& param, int i) {
-   Str result;
+Str param_name(const Param& param, int i) {
    auto name = render(param.name());
-   if (name == "") {
-      result += anon_str + to_string(i);
-   } else {
-      result += name;
-   }
-   result += ": " + render(param.type());
+   return name == "" ? anon_str + to_string(i) : name;
+}
+
+Str render(const Param& param, int i) {
+   Str result = param_name(param, i);
+   auto type = param.type();
+   if (is<RestrictType>(type)) {
+      result += " {.noalias.}";
+   } else if (is<ConstRefType>(type)) {
+      result += " {.byref.}";
+      type = as<ConstRefType>(type).pointee;
+   }
+   result += ": " + render(type);
    if (param.expr()) {
       result += " = " + render(*param.expr());
    }
@@ -260,8 +385,9 @@ Str render(const Param& param, int i) {
 }
 
 Str render_routine_sig(const Str& name, const Opt<Vec<Str>>& template_params,
-                       const Vec<Str>& params, const Opt<Str>& return_type, bool exported) {
-   auto result = "proc " + name;
+                       const Vec<Str>& params, const Opt<Str>& return_type, bool exported,
+                       const Str& kind = "proc") {
+   auto result = kind + " " + name;
    if (exported) {
       result += "*";
    }
@@ -301,82 +427,215 @@ Vec<Str> render(const Params& params) {
    return result;
 }
 
+/// The effect and optimization pragmas of a routine.
+Vec<Str> render(const RoutineAttrs& attrs) {
+   Vec<Str> result;
+   if (attrs.nothrow) {
+      result.push_back("raises: []");
+   }
+   if (attrs.no_side_effect) {
+      result.push_back("no_side_effect");
+   }
+   if (attrs.discardable) {
+      result.push_back("discardable");
+   }
+   return result;
+}
+
+Str render_pragmas(Vec<Str> pragmas, const RoutineAttrs& attrs) {
+   auto attr_pragmas = render(attrs);
+   pragmas.insert(pragmas.end(), attr_pragmas.begin(), attr_pragmas.end());
+   return render_pragmas(pragmas);
+}
+
+/// The argument list of an import pattern. Nim passes arguments as lvalues, so a `sink` argument
+/// is cast back to an rvalue, as `std::move` would. `first` is the nim position of `params[0]`.
+Str import_cpp_args(const Params& params, Size first) {
+   auto sinks = false;
+   for (const auto& param : params) {
+      sinks = sinks || is<RValueRefType>(param.type());
+   }
+   if (!sinks) {
+      return "(@)";
+   }
+   Str result = "(";
+   for (Size i = 0; i < params.size(); i += 1) {
+      result += i == 0 ? "" : ", ";
+      if (is<RValueRefType>(params[i].type())) {
+         result += "static_cast<'" + to_string(first + i) + "&&>(#)";
+      } else {
+         result += "#";
+      }
+   }
+   return result + ")";
+}
+
+/// The import pattern of a routine, with `templ_args` between its name and arguments.
+Str import_cpp_pattern(const FunctionDecl& decl, const Str& templ_args) {
+   return decl.cpp_name + templ_args + import_cpp_args(decl.params, 1);
+}
+
+/// A typedesc receiver does not appear in c++, but an explicit argument list still has to skip
+/// it with a `#` of its own.
+Str skip_receiver(const Str& args) { return args == "(@)" ? "" : "#"; }
+
+Str import_cpp_pattern(const ConstructorDecl& decl, const Str& templ_args) {
+   auto args = import_cpp_args(decl.params, 2);
+   return skip_receiver(args) + decl.cpp_name + templ_args + args;
+}
+
+Str import_cpp_pattern(const MethodDecl& decl, const Str& templ_args) {
+   auto args = import_cpp_args(decl.params, 2);
+   return (decl.is_static ? skip_receiver(args) : "") + decl.cpp_name + templ_args + args;
+}
+
 template <typename T> Str render_pragmas(const T& decl) {
-   return render_pragmas({import_cpp(decl.cpp_name + "(@)"), header(decl.header)});
+   return render_pragmas({import_cpp(import_cpp_pattern(decl, "")), header(decl.header)},
+                         decl.attrs);
 }
 
-template <typename T> Str import_cpp_templ_args(const T& decl) {
+/// The template arguments of an import pattern, which are the typedesc parameters that follow
+/// `params` parameters.
+Str import_cpp_templ_args(Size params, const TemplateParams& template_params) {
    Str result = "<";
-   auto first = true;
-   for (auto i : range(decl.template_params->size() - 1)) {
-      if (!first) {
-         result += ", ";
-      }
-      first = false;
-      result += "'" + to_string(decl.params.size() + i + 1);
+   for (Size i = 0; i < template_params.size(); i += 1) {
+      result += (i == 0 ? "'" : ", '") + to_string(params + i + 1);
    }
-   result += ">";
-   return result;
+   return result + ">";
 }
 
-template <typename T> Str render_templ_pragmas(const T& decl) {
+template <typename T> Str render_templ_pragmas(const T& decl, Size params) {
    return render_pragmas(
-       {import_cpp(decl.cpp_name + import_cpp_templ_args(decl) + "(@)"), header(decl.header)});
+       {import_cpp(import_cpp_pattern(decl, import_cpp_templ_args(params, *decl.template_params))),
+        header(decl.header)},
+       decl.attrs);
 }
 
 Opt<Str> render(const Opt<Type>& type) { return type ? render(*type) : Opt<Str>(); }
 
 Str internal_name(Sym sym) { return sym->latest() + "_internal"; }
 
-Params templ_params(const FunctionDecl& decl) {
-   Params result = decl.params;
-   auto&& template_params = *decl.template_params;
-   for (auto i : range(template_params.size() - 1)) {
-      result.push_back(Param(new_Sym(anon_str + to_string(decl.params.size() + i + 1), true),
-                             typedesc(new_Type(template_params[i]->name))));
+bool infers(const Type& type, const Sym& name);
+
+/// Only a template parameter named directly is inferred, not one computed like `size * 2`.
+bool infers(const Expr& expr, const Sym& name) {
+   return is<ConstParamExpr>(expr) && as<ConstParamExpr>(expr).name->latest() == name->latest();
+}
+
+/// Can a call infer the template parameter `name` from an argument of `type`, in nim and c++.
+bool infers(const Type& type, const Sym& name) {
+   if (is<Sym>(type)) {
+      return as<Sym>(type)->latest() == name->latest();
+   } else if (is<PtrType>(type)) {
+      return infers(as<PtrType>(type).pointee, name);
+   } else if (is<RefType>(type)) {
+      return infers(as<RefType>(type).pointee, name);
+   } else if (is<RValueRefType>(type)) {
+      return infers(as<RValueRefType>(type).pointee, name);
+   } else if (is<ConstRefType>(type)) {
+      return infers(as<ConstRefType>(type).pointee, name);
+   } else if (is<InstType>(type)) {
+      for (const auto& arg : as<InstType>(type).args) {
+         if (visit([&](const auto& value) { return infers(value, name); }, arg)) {
+            return true;
+         }
+      }
+      return false;
+   } else if (is<UnsizedArrayType>(type)) {
+      return infers(as<UnsizedArrayType>(type).type, name);
+   } else if (is<ArrayType>(type)) {
+      return infers(as<ArrayType>(type).size, name) || infers(as<ArrayType>(type).type, name);
+   } else if (is<FuncType>(type)) {
+      const auto& func = as<FuncType>(type);
+      for (const auto& param : func.params) {
+         if (infers(param, name)) {
+            return true;
+         }
+      }
+      return func.return_type && infers(*func.return_type, name);
+   } else if (is<ConstType>(type)) {
+      return infers(as<ConstType>(type).type, name);
+   } else if (is<VolatileType>(type)) {
+      return infers(as<VolatileType>(type).type, name);
+   } else if (is<RestrictType>(type)) {
+      return infers(as<RestrictType>(type).type, name);
+   } else if (is<VectorType>(type)) {
+      return infers(as<VectorType>(type).element, name);
+   } else {
+      return false;
    }
-   return result;
 }
 
-Str render_templ_internal(const FunctionDecl& decl) {
-   return render_routine_sig(internal_name(decl.name), render(decl.template_params),
-                             render(templ_params(decl)), render(decl.return_type), false) +
-          "\n" + indent() + render_templ_pragmas(decl) + "\n";
+/// Does a template routine need a forwarder, because some of its template parameters cannot be
+/// inferred from its parameters.
+bool needs_forwarder(const Params& params, const Opt<TemplateParams>& template_params) {
+   if (template_params) {
+      for (const auto& template_param : *template_params) {
+         auto inferred = false;
+         for (const auto& param : params) {
+            inferred = inferred || infers(param.type(), template_param->name);
+         }
+         if (!inferred) {
+            return true;
+         }
+      }
+   }
+   return false;
 }
 
-Str forward_templ_call(const FunctionDecl& decl) {
-   Str result = internal_name(decl.name) + "(";
-   auto first = true;
-   for (auto i : range(decl.params.size() - 1)) {
-      if (!first) {
-         result += ", ";
-      }
-      first = false;
-      result += render(decl.params[i].name());
+/// Append a typedesc parameter for each template parameter, so the import pattern can name them.
+Params typedesc_params(Params params, const TemplateParams& template_params) {
+   auto count = params.size();
+   for (Size i = 0; i < template_params.size(); i += 1) {
+      params.push_back(Param(new_Sym(anon_str + to_string(count + i + 1), true),
+                             typedesc(new_Type(template_params[i]->name))));
    }
-   for (auto i : range(decl.template_params->size() - 1)) {
-      if (!first) {
-         result += ", ";
-      }
-      first = false;
-      result += render((*decl.template_params)[i]->name);
+   return params;
+}
+
+Str forward_templ_call(Sym name, const Params& params, const TemplateParams& template_params) {
+   Str result = internal_name(name) + "(";
+   for (Size i = 0; i < params.size(); i += 1) {
+      result += (i == 0 ? "" : ", ") + param_name(params[i], i);
    }
-   result += ")";
-   return result;
+   for (Size i = 0; i < template_params.size(); i += 1) {
+      result += (params.size() + i == 0 ? "" : ", ") + render(template_params[i]->name);
+   }
+   return result + ")";
+}
+
+/// A nim template that expands to the import with the template parameters passed explicitly. It
+/// costs nothing at runtime, even without optimizations.
+Str render_forwarder(Sym name, const Opt<Vec<Str>>& template_params, const Params& params,
+                     const Opt<Type>& return_type, const TemplateParams& forwarded) {
+   auto result_type = render(return_type);
+   // A template cannot return `var T`, the import it expands to still does.
+   if (return_type && (is<RefType>(*return_type) || is<ConstRefType>(*return_type))) {
+      result_type = "untyped";
+   }
+   return render_routine_sig(render(name), template_params, render(params), result_type, true,
+                             "template") +
+          " =\n" + indent() + forward_templ_call(name, params, forwarded) + "\n";
+}
+
+Str render_templ_internal(const FunctionDecl& decl) {
+   return render_routine_sig(internal_name(decl.name), render(decl.template_params),
+                             render(typedesc_params(decl.params, *decl.template_params)),
+                             render(decl.return_type), false) +
+          "\n" + indent() + render_templ_pragmas(decl, decl.params.size()) + "\n";
 }
 
 Str render_templ(const FunctionDecl& decl) {
-   return render_routine_sig(render(decl.name), render(decl.template_params), render(decl.params),
-                             render(decl.return_type), true) +
-          " =\n" + indent() + forward_templ_call(decl) + "\n";
+   return render_forwarder(decl.name, render(decl.template_params), decl.params,
+                           decl.return_type, *decl.template_params);
 }
 
 Str render(const FunctionDecl& decl) {
-   if (decl.template_params) {
+   if (needs_forwarder(decl.params, decl.template_params)) {
       return render_templ_internal(decl) + render_templ(decl);
    } else {
-      return render_routine_sig(render(decl.name), {}, render(decl.params),
-                                render(decl.return_type), true) +
+      return render_routine_sig(render(decl.name), render(decl.template_params),
+                                render(decl.params), render(decl.return_type), true) +
              "\n" + indent() + render_pragmas(decl) + "\n";
    }
 }
@@ -387,6 +646,14 @@ Params concat(const Param& param, const Params& params) {
    return result;
 }
 
+Str render(const ShimDecl& decl) {
+   auto params = decl.self ? concat(Param(anon_sym, *decl.self), decl.params) : decl.params;
+   return render_routine_sig(render(decl.name), {}, render(params), render(decl.return_type),
+                             true) +
+          "\n" + indent() +
+          render_pragmas({"import_c: \"" + decl.symbol + "\"", "cdecl"}, decl.attrs) + "\n";
+}
+
 Opt<TemplateParams> concat(const Opt<TemplateParams>& a, const Opt<TemplateParams>& b) {
    if (a || b) {
       TemplateParams result;
@@ -411,21 +678,232 @@ Str render(const ConstructorDecl& decl) {
           "\n" + indent() + render_pragmas(decl) + "\n";
 }
 
-Str render_templ_internal(const MethodDecl& decl) { return ""; }
+/// The parameters of a method with its receiver first.
+Params method_params(const MethodDecl& decl) {
+   return concat(decl.is_static ? type_self_param(decl) : Param(anon_sym, decl.self), decl.params);
+}
 
-Str render_templ(const MethodDecl& decl) { return ""; }
+Str render_templ_internal(const MethodDecl& decl) {
+   auto params = method_params(decl);
+   return render_routine_sig(internal_name(decl.name),
+                             render(concat(decl.self_template_params, decl.template_params)),
+                             render(typedesc_params(params, *decl.template_params)),
+                             render(decl.return_type), false) +
+          "\n" + indent() + render_templ_pragmas(decl, params.size()) + "\n";
+}
+
+Str render_templ(const MethodDecl& decl) {
+   return render_forwarder(decl.name,
+                           render(concat(decl.self_template_params, decl.template_params)),
+                           method_params(decl), decl.return_type, *decl.template_params);
+}
 
 Str render(const MethodDecl& decl) {
-   if (decl.template_params) {
+   if (needs_forwarder(decl.params, decl.template_params)) {
       return render_templ_internal(decl) + render_templ(decl);
    } else {
-      return render_routine_sig(
-                 render(decl.name), render(decl.self_template_params),
-                 render(concat(decl.is_static ? type_self_param(decl) : Param(anon_sym, decl.self),
-                               decl.params)),
-                 render(decl.return_type), true) +
-             "\n" + indent() +
-             render_pragmas({import_cpp(decl.cpp_name + "(@)"), header(decl.header)}) + "\n";
+      return render_routine_sig(render(decl.name),
+                                render(concat(decl.self_template_params, decl.template_params)),
+                                render(method_params(decl)), render(decl.return_type), true) +
+             "\n" + indent() + render_pragmas(decl) + "\n";
+   }
+}
+
+Type managed(Type type) { return new_Type(InstType(new_Type(new_Sym("Cpp")), {type})); }
+
+/// The `Cpp[T]` overload of `name`, or the type bound `hook` itself as an error when the class
+/// lacks it. Erroring in `name` instead would break `Cpp[T]` altogether, since Nim instantiates
+/// every hook eagerly.
+Str render_hook(const HooksDecl& decl, const Str& name, const Str& hook, const Params& params,
+                bool available, const Str& pattern, const Str& missing) {
+   Str result = render_routine_sig(available ? name : hook, {}, render(params), {}, true) +
+                "\n" + indent();
+   if (available) {
+      result += render_pragmas({import_cpp(pattern), header(decl.header)});
+   } else {
+      result += render_pragmas({"error: \"" + decl.cpp_name + " is not " + missing + "\""});
+   }
+   return result + "\n";
+}
+
+Str render(const HooksDecl& decl) {
+   auto self = managed(decl.self);
+   auto var_self = new_Type(RefType(self));
+   Params binary = {Param(new_Sym("dst"), var_self), Param(new_Sym("src"), self)};
+   return render_hook(decl, "cpp_destroy", "`=destroy`", {Param(new_Sym("self"), var_self)},
+                      decl.destructible, "#.detail.unsafe_destroy()", "destructible") +
+          render_hook(decl, "cpp_copy", "`=`", binary, decl.copyable,
+                      "#.detail.unsafe_copy_assign(#.detail)", "copyable") +
+          render_hook(decl, "cpp_sink", "`=sink`", binary, decl.movable,
+                      "#.detail.unsafe_move(#.detail)", "movable");
+}
+
+Str render(const ViewDecl& decl) {
+   auto self_template_params = render(decl.self_template_params);
+   auto result =
+       render_routine_sig("to_open_array", self_template_params,
+                          {"self: " + render(decl.self)}, Str("untyped"), true, "template") +
+       " =\n" + indent() + "cpp_open_array(self, " + render(decl.element) + ")\n";
+   if (decl.from_open_array) {
+      auto elements = new_Type(InstType(new_Type(new_Sym("openArray", true)), {decl.element}));
+      result += render_routine_sig("from_open_array", self_template_params,
+                                   render(Params{Param(anon_sym, typedesc(decl.self)),
+                                                 Param(new_Sym("elements"), elements)}),
+                                   render(decl.self), true) +
+                "\n" + indent() + render_pragmas({import_cpp("'0(@)"), header(decl.header)}) +
+                "\n";
+   }
+   return result;
+}
+
+/// An iterator over the c++ loop of `decl` that yields `yield_expr` for each element.
+Str render_iterator(const IteratorDecl& decl, const Str& name, Type self, const Str& element,
+                    const Str& yield_expr, bool counted) {
+   Str result = render_routine_sig(name, render(decl.self_template_params),
+                                   {"self: " + render(self)}, element, true, "iterator") +
+                " =\n";
+   if (counted) {
+      result += indent() + "var i = 0\n";
+   }
+   result += indent() + "cpp_iterate(self, " + render(decl.iterator) + ", it):\n" + indent() +
+             indent() + "yield " + yield_expr + "\n";
+   if (counted) {
+      result += indent() + indent() + "i += 1\n";
+   }
+   return result;
+}
+
+Str render(const IteratorDecl& decl) {
+   auto element = render(decl.element);
+   auto deref = Str(decl.by_ref ? "cpp_deref" : "cpp_deref_value") + "(it, " + element + ")";
+   auto result = render_iterator(decl, "items", decl.self,
+                                 (decl.by_ref ? "lent " : "") + element, deref, false);
+   if (decl.mutable_elements) {
+      result += render_iterator(decl, "mitems", new_Type(RefType(decl.self)), "var " + element,
+                                deref, false);
+   }
+   return result + render_iterator(decl, "pairs", decl.self,
+                                   "tuple[key: int, val: " + element + "]", "(i, " + deref + ")",
+                                   true);
+}
+
+/// The parameters of a trampoline, `a0`, `a1`, ... with the context at `slot`.
+Vec<Str> trampoline_params(const FuncType& type, Opt<Size> slot) {
+   Vec<Str> result;
+   for (Size i = 0; i < type.params.size(); i += 1) {
+      if (slot && i == *slot) {
+         result.push_back("context: pointer");
+      }
+      result.push_back("a" + to_string(i) + ": " + render(type.params[i]));
+   }
+   if (slot && *slot == type.params.size()) {
+      result.push_back("context: pointer");
+   }
+   return result;
+}
+
+Str trampoline_args(const FuncType& type) {
+   Str result;
+   for (Size i = 0; i < type.params.size(); i += 1) {
+      result += (i == 0 ? "a" : ", a") + to_string(i);
+   }
+   return result;
+}
+
+Str render(const TrampolineDecl& decl) {
+   const auto& signature = as<FuncType>(decl.signature);
+   auto closure = render_routine_sig("", {}, trampoline_params(signature, {}),
+                                     render(signature.return_type), false);
+   Vec<Str> params;
+   Str call = render(decl.name) + "(";
+   if (decl.self) {
+      auto receiver = Param(anon_sym, decl.is_static ? typedesc(*decl.self) : *decl.self);
+      params.push_back(render(receiver, 0));
+      call += param_name(receiver, 0) + (decl.params.size() == 0 ? "" : ", ");
+   }
+   for (Size i = 0; i < decl.params.size(); i += 1) {
+      auto name = param_name(decl.params[i], i);
+      if (i == decl.callback) {
+         params.push_back(name + ": " + closure);
+      } else if (!decl.context || i != *decl.context) {
+         params.push_back(render(decl.params[i], i));
+      }
+      call += i == 0 ? "" : ", ";
+      if (i == decl.callback && decl.function) {
+         call += "cpp_function(cpp_trampoline, addr cpp_closure, " + render(*decl.function) + ")";
+      } else if (i == decl.callback) {
+         call += "cpp_trampoline";
+      } else if (decl.context && i == *decl.context) {
+         call += "addr cpp_closure";
+      } else {
+         call += name;
+      }
+   }
+   call += ")";
+   auto callback = param_name(decl.params[decl.callback], decl.callback);
+   Str result = render_routine_sig(render(decl.name), render(decl.self_template_params), params,
+                                   render(decl.return_type), true) +
+                " =\n";
+   result += indent() +
+             render_routine_sig("cpp_trampoline", {}, trampoline_params(signature, decl.slot),
+                                render(signature.return_type), false) +
+             " " + render_pragmas({"cdecl"}) + " =\n";
+   result += indent() + indent() + "cast[ptr " + closure + "](context)[](" +
+             trampoline_args(signature) + ")\n";
+   result += indent() + "var cpp_closure = " + callback + "\n";
+   return result + indent() + (decl.return_type ? "result = " : "") + call + "\n";
+}
+
+Str render(const AsyncDecl& decl) {
+   auto value = decl.value ? render(*decl.value) : Str("void");
+   Vec<Str> params;
+   Str args;
+   for (Size i = 0; i < decl.params.size(); i += 1) {
+      if ((!decl.callback || i != *decl.callback) && (!decl.context || i != *decl.context)) {
+         params.push_back(render(decl.params[i], i));
+         args += (args.size() == 0 ? "" : ", ") + param_name(decl.params[i], i);
+      }
+   }
+   Str result = render_routine_sig(render(decl.name) + "_async", {}, params,
+                                   "Future[" + value + "]", true) +
+                " =\n";
+   if (decl.future) {
+      auto future = render(*decl.future);
+      params.insert(params.begin(), "held: " + render(new_Type(RefType(managed(*decl.future)))));
+      result += indent() + render_routine_sig("cpp_emplace", {}, params, {}, false) + "\n" +
+                indent() + indent() +
+                render_pragmas({import_cpp("#.detail.unsafe_emplace(" + decl.cpp_name + "(@))"),
+                                header(decl.header)}) +
+                "\n";
+      result += indent() + "let op = cpp_future_operation(" + future + ", " + value + ")\n";
+      result += indent() + "cpp_emplace(cpp_held(op)" + (args.size() == 0 ? "" : ", ") + args +
+                ")\n";
+      return result + indent() + "result = cpp_poll(op)\n";
+   } else {
+      auto op = "cast[ptr CppOperation[" + value + "]](context)";
+      Vec<Str> trampoline_params = {"context: pointer"};
+      if (decl.value) {
+         trampoline_params.insert(trampoline_params.begin() + (*decl.slot == 0 ? 1 : 0),
+                                  "a0: " + value);
+      }
+      result += indent() +
+                render_routine_sig("cpp_trampoline", {}, trampoline_params, {}, false) + " " +
+                render_pragmas({"cdecl"}) + " =\n";
+      result += indent() + indent() + "cpp_complete(" + op + (decl.value ? ", a0" : "") + ")\n";
+      result += indent() + "let op = cpp_operation(" + value + ")\n";
+      result += indent() + "result = cpp_future(op)\n";
+      Str call = render(decl.name) + "(";
+      for (Size i = 0; i < decl.params.size(); i += 1) {
+         call += i == 0 ? "" : ", ";
+         if (i == *decl.callback) {
+            call += "cpp_trampoline";
+         } else if (i == *decl.context) {
+            call += "op";
+         } else {
+            call += param_name(decl.params[i], i);
+         }
+      }
+      return result + indent() + call + ")\n";
    }
 }
 
@@ -449,9 +927,78 @@ template <typename T> Str render_decls(const Vec<T>& decls, Str&& init, bool nee
    }
 }
 
-Str render(const Vec<TypeDecl>& decls) { return render_decls(decls, "\ntype\n", true); }
+Str render_assert(const Str& lhs, U64 rhs) {
+   return indent() + "assert(" + lhs + " == " + to_string(rhs) + ")\n";
+}
+
+/// Check at compile time that nim computes the same layout as clang for a `complete_struct`.
+Str render_layout_asserts(const RecordTypeDecl& decl) {
+   Str result;
+   if (decl.layout && decl.layout->complete) {
+      auto name = render(decl.name);
+      result += render_assert("size_of(" + name + ")", decl.layout->size);
+      result += render_assert("align_of(" + name + ")", decl.layout->align);
+      for (const auto& field : decl.fields) {
+         result += render_assert("offset_of(" + name + ", " + render(field.name) + ")",
+                                 *field.offset);
+      }
+   }
+   return result;
+}
+
+/// The asserts only hold for targets with the pointer size of the one clang parsed for.
+Str render_layout_asserts(const Vec<TypeDecl>& decls) {
+   Str result;
+   U64 pointer_size = 0;
+   for (const auto& decl : decls) {
+      if (is<RecordTypeDecl>(decl)) {
+         const auto& record = as<RecordTypeDecl>(decl);
+         result += render_layout_asserts(record);
+         if (record.layout) {
+            pointer_size = record.layout->pointer_size;
+         }
+      }
+   }
+   if (result.size() == 0) {
+      return "";
+   } else {
+      return "\nwhen size_of(pointer) == " + to_string(pointer_size) + ":\n" + indent() +
+             "static:\n" + indent(result);
+   }
+}
+
+/// Conversions between a flag enum and its set. They reinterpret the bits, so they are free.
+Str render_flag_conversions(const Vec<TypeDecl>& decls) {
+   Str result;
+   for (const auto& decl : decls) {
+      if (is<EnumTypeDecl>(decl) && as<EnumTypeDecl>(decl).flags) {
+         auto name = render(as<EnumTypeDecl>(decl).name);
+         auto flags = render(flags_sym(as<EnumTypeDecl>(decl)));
+         result += "converter to_cpp*(flags: " + flags + "): " + name +
+                   " {.inline.} = cpp_from_flags(flags, " + name + ")\n";
+         result += "proc to_flags*(value: " + name + "): " + flags +
+                   " {.inline.} = cpp_to_flags(value, " + flags + ")\n";
+      }
+   }
+   return result.size() == 0 ? "" : "\n" + result;
+}
+
+Str render(const Vec<TypeDecl>& decls) {
+   return render_decls(decls, "\ntype\n", true) + render_flag_conversions(decls) +
+          render_layout_asserts(decls);
+}
 
 Str render(const Vec<RoutineDecl>& decls) { return render_decls(decls, "\n", false); }
 
 Str render(const Vec<VariableDecl>& decls) { return render_decls(decls, "\nvar\n", true); }
+
+Str render(const ConstantDecl& decl) {
+   Str result = render(decl->name) + "*";
+   if (decl->type) {
+      result += ": " + render(*decl->type);
+   }
+   return result + " = " + render(decl->value) + "\n";
+}
+
+Str render(const Vec<ConstantDecl>& decls) { return render_decls(decls, "\nconst\n", true); }
 } // namespace ensnare
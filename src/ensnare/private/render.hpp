@@ -7,4 +7,5 @@ namespace ensnare {
 Str render(const Vec<TypeDecl>&);
 Str render(const Vec<RoutineDecl>&);
 Str render(const Vec<VariableDecl>&);
+Str render(const Vec<ConstantDecl>&);
 } // namespace ensnare
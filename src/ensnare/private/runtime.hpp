@@ -1,51 +1,203 @@
 #pragma once
 
+#include <cstddef>
+#include <functional>
+#include <iterator>
 #include <memory>
+#include <new>
 #include <type_traits>
 
 namespace ensnare::runtime {
 template <typename T> using UnsizedArray = T[];
 template <typename T> using Constant = std::add_const_t<T>;
+template <typename T> using Volatile = std::add_volatile_t<T>;
+
+namespace detail {
+// Vector attributes on an alias template are ignored by gcc, a member typedef keeps them.
+template <typename T, std::size_t N> struct Vector {
+   typedef T type __attribute__((vector_size(N * sizeof(T))));
+};
+
+#if defined(__clang__)
+template <typename T, std::size_t N> struct ExtVector {
+   typedef T type __attribute__((ext_vector_type(N)));
+};
+#endif
+} // namespace detail
+
+/// A gcc vector extension type of `N` lanes of `T`, like `__m128`. Target specific vectors, such as
+/// neon's `float32x4_t`, are bound as opaque types instead.
+template <typename T, std::size_t N> using Vector = typename detail::Vector<T, N>::type;
+
+#if defined(__clang__)
+/// A clang/OpenCL extended vector of `N` lanes of `T`.
+template <typename T, std::size_t N> using ExtVector = typename detail::ExtVector<T, N>::type;
+#endif
+
+/// The elements of a contiguous container, viewed from nim. Nim tracks mutability itself, so the
+/// constness of the elements is dropped.
+template <typename C> auto data(C& container) {
+   using T = std::remove_const_t<std::remove_pointer_t<decltype(std::data(container))>>;
+   return const_cast<T*>(std::data(container));
+}
+
+template <typename C> std::ptrdiff_t size(C& container) {
+   return static_cast<std::ptrdiff_t>(std::size(container));
+}
+
+/// The element an iterator refers to. Nim tracks mutability itself, so constness is dropped.
+template <typename I> auto& deref(I& it) {
+   using T = std::remove_const_t<std::remove_reference_t<decltype(*it)>>;
+   return const_cast<T&>(*it);
+}
+
+/// A callable made of a `cdecl` trampoline and the nim closure it calls, which is passed first.
+/// It is two pointers and trivially copyable, so `std::function` stores it without allocating.
+template <typename Fn> struct ClosureRef {
+   Fn fn;
+   void* env;
+
+   template <typename... Args> decltype(auto) operator()(Args&&... args) const {
+      return fn(env, std::forward<Args>(args)...);
+   }
+};
+
+/// A `std::function` of type `F` that calls `fn` with `env`.
+template <typename F, typename Fn> F make_function(Fn fn, void* env) {
+   return F(ClosureRef<Fn>{fn, env});
+}
+
+namespace detail {
+/// How a LaunderClassBuf tracks if it holds a live object.
+enum class Liveness {
+   trivial, ///< Trivially copyable, copying or destroying a dead object is as harmless as a memcpy.
+   flagged, ///< An extra `bool` next to the storage.
+};
+
+template <typename T>
+constexpr Liveness liveness_of =
+    std::is_trivially_copyable_v<T> ? Liveness::trivial : Liveness::flagged;
+
+/// Liveness tracking for a buffer. The flag-free variant is empty so it takes no space as a base
+/// class.
+template <typename T, Liveness = liveness_of<T>> class LiveState {
+   public:
+   void arm(void*) {}
+   void disarm(void*) {}
+   bool is_live(const void*) const { return true; }
+};
+
+template <typename T> class LiveState<T, Liveness::flagged> {
+   // We need this flag to not destroy an unitialized object or an already destroyed object.
+   // Both of which are disallowed by the c++ memory model.
+   bool live;
+
+   public:
+   void arm(void*) { this->live = true; }
+   void disarm(void*) { this->live = false; }
+   bool is_live(const void*) const { return this->live; }
+};
+} // namespace detail
 
 /// Do not use. An unsafe POD buffer managed by nim destructors.
-template <typename T> class LaunderClassBuf {
+///
+/// The storage has the size and alignment of `T`. A liveness flag is only added when `T` is not
+/// trivially copyable.
+template <typename T> class LaunderClassBuf : private detail::LiveState<T> {
    private:
-   bool live; // We need this flag to not destroy an unitialized object or
-              // an already destroyed object.// Both of which are
-              // disallowed by the c++ memory model. I think?
-              //
-              // FIXME(optimize), we could use unused bits for cheap
-              // wrapper classes. expoese it with a nice api.
-   std::aligned_storage_t<sizeof(T)> buf; // Storage for one class.
+   alignas(T) unsigned char buf[sizeof(T)]; // Storage for one class.
 
    T& read_buf() {
       // reinterpret the address of the buffer as a pointer
       return *std::launder(reinterpret_cast<T*>(&this->buf));
    }
 
-   public:
-   template <typename... Args> LaunderClassBuf(Args... args) {
-      // forward varariadic args to placement new construction.
+   const T& read_buf() const { return *std::launder(reinterpret_cast<const T*>(&this->buf)); }
+
+   /// Placement new construction of `T` into the buffer. It must not hold a live object.
+   template <typename... Args> void construct(Args&&... args) {
       new (&this->buf) T(std::forward<Args>(args)...);
-      this->live = true; // we have a live object that must be destroyed.
+      this->arm(&this->buf); // we have a live object that must be destroyed.
+   }
+
+   struct Dead {};
+
+   /// A buffer that does not hold a live object.
+   LaunderClassBuf(Dead) { this->disarm(&this->buf); }
+
+   public:
+   /// Construct `T` in place by perfectly forwarding `args` to one of its constructors.
+   template <typename... Args,
+             typename = std::enable_if_t<std::is_constructible_v<T, Args&&...>>>
+   LaunderClassBuf(Args&&... args) {
+      this->construct(std::forward<Args>(args)...);
    }
 
    void unsafe_destroy() {
-      if (this->live) { // if have an initialized object we shall destroy it
-                        // and disarm the buffer.
+      if (this->is_live(&this->buf)) { // if have an initialized object we shall destroy it
+                                       // and disarm the buffer.
          this->read_buf().~T();
-         this->live = false;
+         this->disarm(&this->buf);
       }
    }
 
+   /// Replace any live object with one constructed in place from `args`.
+   template <typename... Args> void unsafe_emplace(Args&&... args) {
+      this->unsafe_destroy();
+      this->construct(std::forward<Args>(args)...);
+   }
+
+   /// Move construct from `other` into this buffer, which must not hold a live object.
+   /// The moved from object is destroyed so `other` is left dead.
+   void unsafe_move_construct(LaunderClassBuf<T>& other) {
+      if (other.is_live(&other.buf)) {
+         this->construct(std::move(other.read_buf()));
+         other.unsafe_destroy();
+      } else {
+         this->disarm(&this->buf);
+      }
+   }
+
+   /// Destroy any live object then move construct from `other`.
    void unsafe_move(LaunderClassBuf<T>& other) {
-      this->read_buf() = std::move(other.read_buf());
-      other.live = false;
+      if (this != &other) {
+         this->unsafe_destroy();
+         this->unsafe_move_construct(other);
+      }
+   }
+
+   /// Copy `other`'s object into this buffer. A live object is copy assigned when `T` allows it,
+   /// otherwise it is destroyed and copy constructed.
+   void unsafe_copy_assign(const LaunderClassBuf<T>& other) {
+      if (this != &other) {
+         if (other.is_live(&other.buf)) {
+            if constexpr (std::is_copy_assignable_v<T> &&
+                          detail::liveness_of<T> != detail::Liveness::trivial) {
+               if (this->is_live(&this->buf)) {
+                  this->read_buf() = other.read_buf();
+                  return;
+               }
+            }
+            this->unsafe_destroy();
+            this->construct(other.read_buf());
+         } else {
+            this->unsafe_destroy();
+         }
+      }
    }
 
    // A binding generator would only expose this if the type supported it.
-   LaunderClassBuf<T> unsafe_copy() { return this->read_buf(); }
+   LaunderClassBuf<T> unsafe_copy() {
+      if (this->is_live(&this->buf)) {
+         return LaunderClassBuf<T>(static_cast<const T&>(this->read_buf()));
+      } else {
+         return LaunderClassBuf<T>(Dead());
+      }
+   }
 
    T& unsafe_deref() { return this->read_buf(); }
 };
+
+static_assert(sizeof(LaunderClassBuf<char>) == sizeof(char));
+static_assert(alignof(LaunderClassBuf<long double>) == alignof(long double));
 } // namespace ensnare::runtime
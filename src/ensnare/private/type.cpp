@@ -6,6 +6,10 @@ ensnare::PtrType::PtrType(Type pointee) : pointee(pointee) {}
 
 ensnare::RefType::RefType(Type pointee) : pointee(pointee) {}
 
+ensnare::RValueRefType::RValueRefType(Type pointee) : pointee(pointee) {}
+
+ensnare::ConstRefType::ConstRefType(Type pointee) : pointee(pointee) {}
+
 ensnare::InstType::InstType(Type type, Vec<Arg> args) : type(type), args(args) {}
 
 ensnare::UnsizedArrayType::UnsizedArrayType(Type type) : type(type) {}
@@ -16,3 +20,10 @@ ensnare::FuncType::FuncType(Vec<Type> params, Opt<Type> return_type)
    : params(params), return_type(return_type) {}
 
 ensnare::ConstType::ConstType(Type type) : type(type) {}
+
+ensnare::VolatileType::VolatileType(Type type) : type(type) {}
+
+ensnare::RestrictType::RestrictType(Type type) : type(type) {}
+
+ensnare::VectorType::VectorType(Type element, U64 lanes, bool ext)
+   : element(element), lanes(lanes), ext(ext) {}
@@ -7,16 +7,22 @@
 namespace ensnare {
 class PtrType;
 class RefType;
+class RValueRefType;
+class ConstRefType;
 class OpaqueType;
 class InstType;
 class UnsizedArrayType;
 class ArrayType;
 class FuncType;
 class ConstType;
+class VolatileType;
+class RestrictType;
+class VectorType;
 
 /// Some kind of type. Should be stored within a Node.
-using TypeObj = Union<Sym, PtrType, RefType, OpaqueType, InstType, UnsizedArrayType, ArrayType,
-                      FuncType, ConstType>;
+using TypeObj = Union<Sym, PtrType, RefType, RValueRefType, ConstRefType, OpaqueType, InstType,
+                      UnsizedArrayType, ArrayType, FuncType, ConstType, VolatileType, RestrictType,
+                      VectorType>;
 
 using Type = Node<TypeObj>;
 
@@ -36,6 +42,21 @@ class RefType {
    RefType(Type pointee);
 };
 
+/// A c++ rvalue reference: `T&&`. It is a nim `sink` parameter, the import moves the argument.
+class RValueRefType {
+   public:
+   const Type pointee;
+   RValueRefType(Type pointee);
+};
+
+/// A c++ reference to const: `const T&`. A parameter is read only and passed `byref` as a `T`, so
+/// temporaries and `let` values need no copy. Anywhere else it is a `var CppConst[T]`.
+class ConstRefType {
+   public:
+   const Type pointee; ///< Without the const.
+   ConstRefType(Type pointee);
+};
+
 /// Kinda dumb. What is it?
 class OpaqueType {};
 
@@ -76,4 +97,28 @@ class ConstType {
    const Type type;
    ConstType(Type type);
 };
+
+/// A volatile qualified type. Every access must go through memory: `volatile T`
+class VolatileType {
+   public:
+   const Type type;
+   VolatileType(Type type);
+};
+
+/// A `__restrict` qualified pointer. Nim can only express this on parameters, as `noalias`,
+/// anywhere else it is the plain pointer.
+class RestrictType {
+   public:
+   const Type type;
+   RestrictType(Type type);
+};
+
+/// A simd vector of a fixed number of lanes: `T __attribute__((vector_size(N * sizeof(T))))`
+class VectorType {
+   public:
+   const Type element;
+   const U64 lanes;
+   const bool ext; ///< A clang `ext_vector_type` rather than a gcc `vector_size` vector.
+   VectorType(Type element, U64 lanes, bool ext);
+};
 } // namespace ensnare
@@ -22,6 +22,21 @@ macro cpp_expr*(T, pattern, args): auto =
                         nnkEmpty{}, nnkEmpty{}}
    result = nnkStmtList{def, call}
 
+macro cpp_self_expr*(T, pattern, self, args): auto =
+   ## Like `cpp_expr` but `self` is passed as a mutable first argument, so `pattern` can refer to
+   ## it with `#` and to `args` with `@`.
+   let id = nskProc{"cpp_expr"}
+   let formals = nnkFormalParams{T, nnkIdentDefs{nskParam{"cpp_self"}, nnkVarTy{"auto".ident},
+                                                 nnkEmpty{}}}
+   let call = nnkCall{id, self}
+   for arg in args:
+      formals.add(nnkIdentDefs{nskParam{"cpp_arg"}, "auto".ident, nnkEmpty{}})
+      call.add(arg)
+   let def = nnkProcDef{id, nnkEmpty{}, nnkEmpty{}, formals,
+                        nnkPragma{nnkExprColonExpr{"import_cpp".ident, pattern}},
+                        nnkEmpty{}, nnkEmpty{}}
+   result = nnkStmtList{def, call}
+
 const hpp = "ensnare/private/runtime.hpp"
 
 type LaunderClassBuf*[T] {.import_cpp: "ensnare::runtime::LaunderClassBuf<'0>",
@@ -33,6 +48,12 @@ proc unsafe_destroy[T](self: var LaunderClassBuf[T])
 proc unsafe_move[T](this: var LaunderClassBuf[T], other: LaunderClassBuf[T])
    {.import_cpp: "#.unsafe_move(@)".}
 
+proc unsafe_copy_assign[T](this: var LaunderClassBuf[T], other: LaunderClassBuf[T])
+   {.import_cpp: "#.unsafe_copy_assign(@)".}
+
+proc unsafe_move_construct[T](this: var LaunderClassBuf[T], other: var LaunderClassBuf[T])
+   {.import_cpp: "#.unsafe_move_construct(@)".}
+
 proc unsafe_copy[T](this: LaunderClassBuf[T]): LaunderClassBuf[T]
    {.import_cpp: "#.unsafe_copy(@)".}
 
@@ -46,17 +67,48 @@ template unsafe_copy*[T](this: Cpp[T]): Cpp[T] =
    ## An implimentation would expose this with `copy` if it is a copyable type.
    Cpp[T](detail: unsafe_copy(this.detail))
 
-proc `=destroy`[T](self: var Cpp[T]) =
+# The lifetime hooks of `Cpp[T]` dispatch to `cpp_destroy`, `cpp_copy` and `cpp_sink`.
+# ensnare emits overloads of these for each bound class from its c++ special members, and
+# the hook itself as an error for those it lacks. These generic versions are the fallback for
+# anything else, like template instantiations, and must stay usable since Nim instantiates
+# all the hooks of `Cpp[T]` as soon as it is used.
+
+proc cpp_destroy*[T](self: var Cpp[T]) {.inline.} =
    unsafe_destroy(self.detail)
 
-proc `=`*[T](dst: var Cpp[T], src: Cpp[T]) {.error: "use `copy` instead; if available.".}
+proc cpp_copy*[T](dst: var Cpp[T], src: Cpp[T]) {.inline.} =
+   unsafe_copy_assign(dst.detail, src.detail)
 
-proc `=sink`*[T](dst: var Cpp[T], src: Cpp[T]) =
+proc cpp_sink*[T](dst: var Cpp[T], src: Cpp[T]) {.inline.} =
    unsafe_move(dst.detail, src.detail)
 
+proc `=destroy`[T](self: var Cpp[T]) =
+   mixin cpp_destroy
+   cpp_destroy(self)
+
+proc `=`*[T](dst: var Cpp[T], src: Cpp[T]) =
+   mixin cpp_copy
+   cpp_copy(dst, src)
+
+proc `=sink`*[T](dst: var Cpp[T], src: Cpp[T]) =
+   mixin cpp_sink
+   cpp_sink(dst, src)
+
 template `{}`*[T](Self: type[Cpp[T]], args: varargs[untyped]): Cpp[T] =
    Cpp[T](detail: cpp_expr(LaunderClassBuf[T], "'0(@)", args))
 
+template emplace*[T](self: var Cpp[T], args: varargs[untyped]) =
+   ## Replace the object held by `self` with one constructed in place. The arguments are
+   ## perfectly forwarded to a constructor of `T`.
+   cpp_self_expr(void, "#.unsafe_emplace(@)", self.detail, args)
+
+proc cpp_move*[T](self: var Cpp[T]): Cpp[T] =
+   ## Move construct the object held by `self` into a new `Cpp[T]`. `self` is left empty.
+   unsafe_move_construct(result.detail, self.detail)
+
+proc cpp_move*[T](self: var T): T {.import_cpp: "std::move(#)", header: "<utility>".}
+   ## `std::move`, so an object can be passed on to c++ as an rvalue: `x.emplace(cpp_move(y))`.
+
 template deref*[T](self: Cpp[T]): lent T = unsafe_deref(self.detail)
 
 const cstddef_h = "<cstddef>"
@@ -108,6 +160,7 @@ type # exntensions
 
 type
    CppConst*[T] {.import_cpp: "ensnare::runtime::Constant<'0>", header: hpp.} = object
+   CppVolatile*[T] {.import_cpp: "ensnare::runtime::Volatile<'0>", header: hpp.} = object
    CppUnsizedArray*[T] {.import_cpp: "ensnare::runtime::UnsizedArray<'0>", header: hpp.} = object
    CppCharPtr* = ptr CppConst[CppChar]
    CppUCharPtr* = ptr CppConst[CppUChar]
@@ -115,6 +168,82 @@ type
 proc `=`*[T](dst: var CppUnsizedArray[T], src: CppUnsizedArray[T]) {.error.}
 proc `=sink`*[T](dst: var CppUnsizedArray[T], src: CppUnsizedArray[T]) {.error.}
 
+proc volatile_load*[T](src: ptr CppVolatile[T]): T {.import_cpp: "(*#)".}
+   ## Read through a volatile pointer. The c++ compiler emits exactly one load.
+proc volatile_store*[T](dst: ptr CppVolatile[T], val: T) {.import_cpp: "(*#) = #".}
+   ## Write through a volatile pointer. The c++ compiler emits exactly one store.
+
+type
+   # The lanes give nim the right size, the c++ type carries the vector alignment.
+   CppVector*[T; N: static int] {.import_cpp: "ensnare::runtime::Vector<'0, '1>", header: hpp,
+                                  bycopy.} = object
+      lanes: array[N, T]
+   CppExtVector*[T; N: static int] {.import_cpp: "ensnare::runtime::ExtVector<'0, '1>",
+                                     header: hpp, bycopy.} = object
+      lanes: array[N, T]
+
+template vector_ops(V: untyped) =
+   proc `[]`*[T; N: static int](self: V[T, N], i: int): T {.import_cpp: "#[#]".}
+   proc `[]=`*[T; N: static int](self: var V[T, N], i: int, val: T) {.import_cpp: "#[#] = #".}
+   proc `+`*[T; N: static int](a, b: V[T, N]): V[T, N] {.import_cpp: "(# + #)".}
+   proc `-`*[T; N: static int](a, b: V[T, N]): V[T, N] {.import_cpp: "(# - #)".}
+   proc `*`*[T; N: static int](a, b: V[T, N]): V[T, N] {.import_cpp: "(# * #)".}
+   proc `/`*[T; N: static int](a, b: V[T, N]): V[T, N] {.import_cpp: "(# / #)".}
+
+vector_ops(CppVector)
+vector_ops(CppExtVector)
+
+# Classes with `data()` and `size()` members get `to_open_array`, a view of their elements.
+
+proc cpp_data[C; T](self: ptr C, _: type[T]): ptr T
+   {.import_cpp: "ensnare::runtime::data(*#)", header: hpp.}
+proc cpp_len[C](self: ptr C): int {.import_cpp: "ensnare::runtime::size(*#)", header: hpp.}
+
+template cpp_open_array*[T](self: typed, _: type[T]): untyped =
+   ## The contiguous elements of `self` as an `openArray`, without a copy. `self` must be a
+   ## location that outlives the view.
+   to_open_array(cast[ptr UncheckedArray[T]](cpp_data(unsafe_addr(self), T)), 0,
+                 cpp_len(unsafe_addr(self)) - 1)
+
+# Classes with `begin()` and `end()` get `items`, `mitems` and `pairs` that inline to the c++ loop.
+
+proc cpp_begin[C; I](self: ptr C, _: type[I]): I {.import_cpp: "#->begin()".}
+proc cpp_end[C; I](self: ptr C, _: type[I]): I {.import_cpp: "#->end()".}
+proc cpp_inc[I](it: var I) {.import_cpp: "(++#)".}
+proc cpp_ne[I](a: I, b: I): bool {.import_cpp: "(# != #)".}
+
+proc cpp_deref*[I; T](it: I, _: type[T]): var T
+   {.import_cpp: "ensnare::runtime::deref(#)", header: hpp.}
+   ## The element `it` refers to, without a copy.
+proc cpp_deref_value*[I; T](it: I, _: type[T]): T {.import_cpp: "(*#)".}
+   ## The element an iterator that yields values produces.
+
+template cpp_iterate*(self: typed, I: typedesc, it, body: untyped) =
+   ## Run `body` with `it` set to each c++ iterator of type `I` from `self.begin()` up to
+   ## `self.end()`.
+   var it = cpp_begin(unsafe_addr(self), I)
+   let last = cpp_end(unsafe_addr(self), I)
+   while cpp_ne(it, last):
+      body
+      cpp_inc(it)
+
+proc cpp_function*[P; F](trampoline: P, env: pointer, _: type[F]): F
+   {.import_cpp: "ensnare::runtime::make_function<'0>(@)", header: hpp.}
+   ## A `std::function` that calls `trampoline` with `env` first. Nothing is allocated.
+
+# Flag enums are bound with a nim set of their bits. Bit `i` of the c++ value is the element with
+# ordinal `i`, which is how nim lays out a set whose lowest element is `0`.
+
+func cpp_from_flags*[T: enum; E: enum](flags: set[T], _: type[E]): E {.inline.} =
+   ## The c++ flag enum value with the bits of `flags`.
+   static: assert(size_of(set[T]) <= size_of(E) and cpu_endian == little_endian)
+   copy_mem(addr result, unsafe_addr flags, size_of(flags))
+
+func cpp_to_flags*[E: enum; T: enum](value: E, _: type[set[T]]): set[T] {.inline.} =
+   ## The bits of a c++ flag enum value. Bits without a field are expected to be clear.
+   static: assert(size_of(set[T]) <= size_of(E) and cpu_endian == little_endian)
+   copy_mem(addr result, unsafe_addr value, size_of(result))
+
 type # <cstddef> types
    CppSize* {.import_cpp: "std::size_t", header: cstddef_h.} = uint
    CppPtrDiff* {.import_cpp: "std::ptrdiff_t", header: cstddef_h.} = int
@@ -195,6 +324,19 @@ elif defined(stdcpp20):
 else:
    cpp_forward_compiler("-std=c++17")
 
+# ensnare maps `char` to an unsigned type, see `CppChar`.
+cpp_forward_compiler("-funsigned-char")
+
+proc cpp_pch_usable*(pch: string): bool {.compile_time.} =
+   ## If the backend can use the header `pch` that ensnare precompiled. Only the clang version
+   ## that wrote it reads it, and only with the same language options, which are the defaults
+   ## above. So clang tries it out.
+   when defined(clang) and not defined(stdcpp20) and not defined(no_stdcpp):
+      gorge_ex("clang++ -fsyntax-only -std=c++17 -funsigned-char -xc++ -include-pch " &
+               quote_shell(pch) & " -").exit_code == 0
+   else:
+      false
+
 when defined(address_sanitizer):
    cpp_forward_compiler("-fsanitize=address -fno-omit-frame-pointer")
    cpp_forward_linker("-fsanitize=address")
@@ -7,6 +7,7 @@ type
       src: string
    Test = object
       bindings: string
+      files: seq[tuple[name, src: string]] ## Other generated files, like the umbrella header.
       program: string
 
 proc consume(i: var int, lines: openarray[string]): TestSection =
@@ -30,35 +31,63 @@ proc `{}`*(Self: type[Test], path: string): Self =
          result.bindings = section.src.strip(leading=false, trailing=true) & '\n'
       elif section.directives.len == 1 and section.directives[0] == "run":
          result.program = section.src
+      elif section.directives.len == 1 and section.directives[0].starts_with("file "):
+         result.files.add((section.directives[0]["file ".len .. ^1].strip,
+                           section.src.strip(chars={'\n'}) & '\n'))
       else:
          fatal("failed to parse directives: ", $section.directives)
 
-const tests = ["typedefs", "abc", "redecls", "templ"]
+const tests = ["typedefs", "abc", "redecls", "templ", "layout", "consts", "enums", "views",
+               "callbacks", "instantiate", "shims", "umbrella", "lifetime", "pch"]
 const units = "tests"/"units"
+const smoke_tests = [("instantiate", "-instantiate=std::vector<int>")]
+   ## Bindings too big and too dependent on the standard library to keep, they only have to
+   ## generate.
 
-proc nim_gen_file(name: string): string = units/"gen"/name.change_file_ext(".nim")
+proc flags(test: string): seq[string] =
+   ## Options some tests are generated with, besides the include dir.
+   case test:
+   of "instantiate": @["-instantiate=Pair<int, float>", "-instantiate=Pair<int, Box<float>>"]
+   of "shims": @["-shims"]
+   of "umbrella": @["-umbrella"]
+   of "pch": @["-pch"]
+   else: @[]
+
+proc gen_file(name: string): string = units/"gen"/name
+
+proc nim_gen_file(name: string): string = gen_file(name.change_file_ext(".nim"))
 
 proc nim_test_file(name: string): string = units/name.change_file_ext(".nim")
 
+proc diff(expected, path: string): tuple[output: string, code: int] =
+   let (dir, name, ext) = split_file(path)
+   let diff_file = dir/(name & "-diff" & ext)
+   write_file(diff_file, expected)
+   result = exec("diff", ["--color=always", "-u", diff_file, path])
+
 proc run_tests =
    for test in tests:
       let test_path = units/test.change_file_ext(".nim")
       let test_spec = Test{test_path}
-      let (output, code) = exec("bin/ensnare", ["-include-dir=" & units, nim_gen_file(test),
-                                                test.change_file_ext(".hpp")])
+      let (output, code) = exec("bin/ensnare", @["-include-dir=" & units] & flags(test) &
+                                               @[nim_gen_file(test), test.change_file_ext(".hpp")])
 
       if code == 0:
          if output.len != 0:
             echo "Ensnare Output:\n"
             echo indent(output, 3)
-         let diff_file = nim_gen_file(test & "-diff")
-         write_file(diff_file, test_spec.bindings)
-         let (diff_output, diff_code) = exec("diff", ["--color=always", "-u", diff_file,
-                                                      nim_gen_file(test)])
+         var (diff_output, diff_code) = diff(test_spec.bindings, nim_gen_file(test))
+         for file in test_spec.files:
+            if diff_code == 0:
+               (diff_output, diff_code) = diff(file.src, gen_file(file.name))
          if diff_code == 0:
             if test_spec.program.len != 0:
-               # FIXME: this shuold be its own file and import the bindings instead.
-               let (output, code) = exec("nim", ["cpp", "-r", test_path])
+               # It is run next to the bindings, where their companion files are.
+               # FIXME: this should import the bindings instead of repeating them.
+               let program_file = nim_gen_file(test & "_run")
+               write_file(program_file, test_spec.bindings & '\n' & test_spec.program)
+               let (output, code) = exec("nim", ["cpp", "-r", "--passC:-I" &
+                                                 quote_shell(absolute_path(units)), program_file])
                if code == 0:
                   echo "Test Success: ", test
                else:
@@ -79,5 +108,19 @@ proc run_tests =
          echo "Output:\n", indent(output, 3)
          quit 1
 
+proc run_smoke_tests =
+   for (test, flag) in smoke_tests:
+      let (output, code) = exec("bin/ensnare", @["-include-dir=" & units, flag,
+                                               nim_gen_file(test & "_smoke"),
+                                               test.change_file_ext(".hpp")])
+      if code == 0:
+         echo "Test Success: ", test, " ", flag
+      else:
+         echo "Test Failure: ", test, " ", flag
+         echo "Code: ", code
+         echo "Output:\n", indent(output, 3)
+         quit 1
+
 main:
    run_tests()
+   run_smoke_tests()
@@ -23,6 +23,12 @@ using VP = void*;
 
 auto sum(float a, float b) -> float { return a + b; }
 
+__attribute__((const)) auto negate(int x) noexcept -> int { return -x; }
+
+void axpy(float a, const float* __restrict x, float* __restrict y) { *y += a * *x; }
+
+auto poll(volatile int* reg) -> int { return *reg; }
+
 blah::Foo x(1, 2);
 } // namespace blah
 
@@ -63,3 +69,44 @@ using FnPtr = void (*)(int a);
 using FnRef = void (&)(int a);
 using FnRValueRef = void(&&)(int a);
 
+typedef float float4 __attribute__((vector_size(16)));
+
+auto sum_lanes(float4 v) -> float { return v[0] + v[1] + v[2] + v[3]; }
+
+struct Tally {
+   int copies = 0;
+   int moves = 0;
+
+   void add(const Tally& other) { copies += 1; }
+   void add(Tally&& other) { moves += 1; }
+};
+
+// Only the by value overload is bound, C++ cannot pick between them for an rvalue.
+auto keep(int x) -> int { return x; }
+auto keep(int&& x) -> int { return x + 1; }
+
+auto total(const Tally& tally) -> int { return tally.copies + tally.moves; }
+
+// Nim cannot pick between `T` and `{.byref.} T` either, so only the by value overload is bound.
+auto weigh(Tally tally) -> int { return tally.copies; }
+auto weigh(const Tally& tally) -> int { return tally.moves; }
+
+// The private rvalue reference overload does not hide the public one.
+class Vault {
+   int stored = 0;
+
+   void put(Tally&& tally) { stored = 2; }
+
+   public:
+   void put(const Tally& tally) { stored = 1; }
+
+   auto get() const -> int { return stored; }
+};
+
+// Neither does an rvalue reference overload that is itself `&&` qualified.
+struct Scratch {
+   int used = 0;
+
+   void take(const Tally& tally) & { used = 1; }
+   void take(Tally&& tally) && { used = 2; }
+};
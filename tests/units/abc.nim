@@ -5,23 +5,46 @@ type
    `blah-Foo`* {.import_cpp: "blah::Foo", header: "abc.hpp".} = object
       recursive_field: ptr `blah-Foo`
    `blah-VP`* = pointer
-   SomeEnum* {.import_cpp: "SomeEnum", header: "abc.hpp".} = enum
+   SomeEnum* {.import_cpp: "SomeEnum", header: "abc.hpp", size: 4.} = enum
       a = 0
       b = 1
       c = 2
-   TypedefTest* {.import_cpp: "TypedefTest", header: "abc.hpp".} = object
-   `TypedefTest-TypedefNamedNamed`* {.import_cpp: "TypedefTest::TypedefNamedNamed", header: "abc.hpp".} = object
-   `TypedefTest-TypedefAnonNamed`* {.import_cpp: "TypedefTest::TypedefAnonNamed", header: "abc.hpp".} = object
-   `TypedefTest-TypedefNamedAnon`* {.import_cpp: "TypedefTest::TypedefNamedAnon", header: "abc.hpp".} = object
-   `type_of(XYZ-xyz_field)`* {.import_cpp: "decltype(XYZ::xyz_field)", header: "abc.hpp".} = object
-   XYZ* {.import_cpp: "XYZ", header: "abc.hpp".} = object
+   TypedefTest* {.import_cpp: "TypedefTest", header: "abc.hpp", bycopy.} = object
+   `TypedefTest-TypedefNamedNamed`* {.import_cpp: "TypedefTest::TypedefNamedNamed", header: "abc.hpp", bycopy.} = object
+   `TypedefTest-TypedefAnonNamed`* {.import_cpp: "TypedefTest::TypedefAnonNamed", header: "abc.hpp", bycopy.} = object
+   `TypedefTest-TypedefNamedAnon`* {.import_cpp: "TypedefTest::TypedefNamedAnon", header: "abc.hpp", bycopy.} = object
+   `type_of(XYZ-xyz_field)`* {.import_cpp: "decltype(XYZ::xyz_field)", header: "abc.hpp", bycopy.} = object
+   XYZ* {.import_cpp: "XYZ", header: "abc.hpp", bycopy.} = object
       xyz_field: `type_of(XYZ-xyz_field)`
-   `type_of(anon_union_var)`* {.import_cpp: "decltype(anon_union_var)", header: "abc.hpp".} = object
-   SepTypedef* {.import_cpp: "SepTypedef", header: "abc.hpp".} = object
-   FnPtr* = proc (�0: CppInt)
-   FnRef* = proc (�0: CppInt)
-   FnRValueRef* = proc (�0: CppInt)
+   `type_of(anon_union_var)`* {.import_cpp: "decltype(anon_union_var)", header: "abc.hpp", bycopy.} = object
+   SepTypedef* {.import_cpp: "SepTypedef", header: "abc.hpp", bycopy.} = object
+   FnPtr* = proc (�0: CppInt) {.cdecl.}
+   FnRef* = proc (�0: CppInt) {.cdecl.}
+   FnRValueRef* = proc (�0: CppInt) {.cdecl.}
+   float4* = CppVector[CppFloat, 4]
+   Tally* {.import_cpp: "Tally", header: "abc.hpp", bycopy, complete_struct.} = object
+      copies: CppInt
+      moves: CppInt
+   Vault* {.import_cpp: "Vault", header: "abc.hpp", bycopy.} = object
+   Scratch* {.import_cpp: "Scratch", header: "abc.hpp", bycopy, complete_struct.} = object
+      used: CppInt
 
+when size_of(pointer) == 8:
+   static:
+      assert(size_of(Tally) == 8)
+      assert(align_of(Tally) == 4)
+      assert(offset_of(Tally, copies) == 0)
+      assert(offset_of(Tally, moves) == 4)
+      assert(size_of(Scratch) == 4)
+      assert(align_of(Scratch) == 4)
+      assert(offset_of(Scratch, used) == 0)
+
+proc cpp_destroy*(self: var Cpp[`blah-Foo`])
+   {.import_cpp: "#.detail.unsafe_destroy()", header: "abc.hpp".}
+proc cpp_copy*(dst: var Cpp[`blah-Foo`], src: Cpp[`blah-Foo`])
+   {.import_cpp: "#.detail.unsafe_copy_assign(#.detail)", header: "abc.hpp".}
+proc cpp_sink*(dst: var Cpp[`blah-Foo`], src: Cpp[`blah-Foo`])
+   {.import_cpp: "#.detail.unsafe_move(#.detail)", header: "abc.hpp".}
 proc `{}`*(�: type[`blah-Foo`], a: CppInt, b: CppInt): `blah-Foo`
    {.import_cpp: "'0(@)", header: "abc.hpp".}
 proc recusive_meth*(�: `blah-Foo`, x: ptr CppConst[`blah-Foo`])
@@ -29,11 +52,33 @@ proc recusive_meth*(�: `blah-Foo`, x: ptr CppConst[`blah-Foo`])
 proc calc*(�: `blah-Foo`, x: CppInt): CppInt
    {.import_cpp: "#.calc(@)", header: "abc.hpp".}
 proc init*(�: type[`blah-Foo`], a: CppInt = 12): `blah-Foo`
-   {.import_cpp: "'0::init(@)", header: "abc.hpp".}
-proc `{}`*(�: type[`blah-Foo`], �1: var CppConst[`blah-Foo`]): `blah-Foo`
-   {.import_cpp: "'0(@)", header: "abc.hpp".}
+   {.import_cpp: "'1::init(@)", header: "abc.hpp".}
+proc `{}`*(�: type[`blah-Foo`], �1 {.byref.}: `blah-Foo`): `blah-Foo`
+   {.import_cpp: "'0(@)", header: "abc.hpp", raises: [].}
 proc sum*(a: CppFloat, b: CppFloat): CppFloat
    {.import_cpp: "blah::sum(@)", header: "abc.hpp".}
+proc negate*(x: CppInt): CppInt
+   {.import_cpp: "blah::negate(@)", header: "abc.hpp", raises: [], no_side_effect.}
+proc axpy*(a: CppFloat, x {.noalias.}: ptr CppConst[CppFloat], y {.noalias.}: ptr CppFloat)
+   {.import_cpp: "blah::axpy(@)", header: "abc.hpp".}
+proc poll*(reg: ptr CppVolatile[CppInt]): CppInt
+   {.import_cpp: "blah::poll(@)", header: "abc.hpp".}
+proc sum_lanes*(v: float4): CppFloat
+   {.import_cpp: "sum_lanes(@)", header: "abc.hpp".}
+proc add*(�: Tally, other: sink Tally)
+   {.import_cpp: "#.add(static_cast<'2&&>(#))", header: "abc.hpp".}
+proc keep*(x: CppInt): CppInt
+   {.import_cpp: "keep(@)", header: "abc.hpp".}
+proc total*(tally {.byref.}: Tally): CppInt
+   {.import_cpp: "total(@)", header: "abc.hpp".}
+proc weigh*(tally: Tally): CppInt
+   {.import_cpp: "weigh(@)", header: "abc.hpp".}
+proc put*(�: Vault, tally {.byref.}: Tally)
+   {.import_cpp: "#.put(@)", header: "abc.hpp".}
+proc get*(�: Vault): CppInt
+   {.import_cpp: "#.get(@)", header: "abc.hpp".}
+proc take*(�: Scratch, tally {.byref.}: Tally)
+   {.import_cpp: "#.take(@)", header: "abc.hpp".}
 
 var
    `blah-x`* {.import_cpp: "blah::x", header: "abc.hpp".}: `blah-Foo`
@@ -51,5 +96,33 @@ proc main =
    let x = `blah-Foo`{1, 2}
    assert(x.calc(3) == 6)
    assert(sum(1, 3) == 4)
+   assert(negate(2) == -2)
+   var a, b: CppFloat = 2
+   axpy(3, addr a, addr b)
+   assert(b == 8)
+   var reg: CppInt = 5
+   assert(poll(cast[ptr CppVolatile[CppInt]](addr reg)) == 5)
+   var v: float4
+   for i in 0 ..< 4:
+      v[i] = CppFloat(i)
+   assert(sum_lanes(v + v) == 12)
+   var y = Cpp[`blah-Foo`]{3, 4}
+   let z = y
+   assert(z.deref.calc(1) == 8)
+   var t = Tally()
+   t.add(Tally())
+   assert(t.moves == 1 and t.copies == 0)
+   # An lvalue, so C++ can pick the by value overload.
+   var n: CppInt = 1
+   assert(keep(n) == 1)
+   let u = Tally()
+   assert(total(u) == 0)
+   assert(total(t) == 1)
+   var vault = Vault()
+   vault.put(u)
+   assert(vault.get == 1)
+   var scratch = Scratch()
+   scratch.take(u)
+   assert(scratch.used == 1)
 
 main()
@@ -0,0 +1,36 @@
+#include <future>
+
+inline void each(int count, void (*visit)(void* context, int i), void* context) {
+   for (int i = 0; i < count; i += 1) {
+      visit(context, i);
+   }
+}
+
+inline auto sum_mapped(int count, int (*transform)(int i, void* context), void* context) -> int {
+   auto result = 0;
+   for (int i = 0; i < count; i += 1) {
+      result += transform(i, context);
+   }
+   return result;
+}
+
+inline void compute(int x, void (*done)(void* context, int result), void* context) {
+   done(context, x * 2);
+}
+
+struct Range {
+   int count;
+
+   void each(void (*visit)(void* context, int i), void* context) const {
+      for (int i = 0; i < count; i += 1) {
+         visit(context, i);
+      }
+   }
+};
+
+// Ready at once, nim still polls it like any other.
+inline auto compute_later(int x) -> std::future<int> {
+   std::promise<int> promise;
+   promise.set_value(x * 3);
+   return promise.get_future();
+}
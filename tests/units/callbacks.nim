@@ -0,0 +1,74 @@
+import ensnare/runtime
+export runtime
+import ensnare/cpp_async
+export cpp_async
+
+type
+   Range* {.import_cpp: "Range", header: "callbacks.hpp", bycopy, complete_struct.} = object
+      count: CppInt
+   `std-future`* [�Res] {.import_cpp: "std::future<'0>", header: "callbacks.hpp".} = object
+
+when size_of(pointer) == 8:
+   static:
+      assert(size_of(Range) == 4)
+      assert(align_of(Range) == 4)
+      assert(offset_of(Range, count) == 0)
+
+proc each*(count: CppInt, visit: proc (�0: pointer, �1: CppInt) {.cdecl.}, context: pointer)
+   {.import_cpp: "each(@)", header: "callbacks.hpp".}
+proc each*(count: CppInt, visit: proc (a0: CppInt)) =
+   proc cpp_trampoline(context: pointer, a0: CppInt) {.cdecl.} =
+      cast[ptr proc (a0: CppInt)](context)[](a0)
+   var cpp_closure = visit
+   each(count, cpp_trampoline, addr cpp_closure)
+proc sum_mapped*(count: CppInt, transform: proc (�0: CppInt, �1: pointer): CppInt {.cdecl.}, context: pointer): CppInt
+   {.import_cpp: "sum_mapped(@)", header: "callbacks.hpp".}
+proc sum_mapped*(count: CppInt, transform: proc (a0: CppInt): CppInt): CppInt =
+   proc cpp_trampoline(a0: CppInt, context: pointer): CppInt {.cdecl.} =
+      cast[ptr proc (a0: CppInt): CppInt](context)[](a0)
+   var cpp_closure = transform
+   result = sum_mapped(count, cpp_trampoline, addr cpp_closure)
+proc compute*(x: CppInt, done: proc (�0: pointer, �1: CppInt) {.cdecl.}, context: pointer)
+   {.import_cpp: "compute(@)", header: "callbacks.hpp".}
+proc compute*(x: CppInt, done: proc (a0: CppInt)) =
+   proc cpp_trampoline(context: pointer, a0: CppInt) {.cdecl.} =
+      cast[ptr proc (a0: CppInt)](context)[](a0)
+   var cpp_closure = done
+   compute(x, cpp_trampoline, addr cpp_closure)
+proc compute_async*(x: CppInt): Future[CppInt] =
+   proc cpp_trampoline(context: pointer, a0: CppInt) {.cdecl.} =
+      cpp_complete(cast[ptr CppOperation[CppInt]](context), a0)
+   let op = cpp_operation(CppInt)
+   result = cpp_future(op)
+   compute(x, cpp_trampoline, op)
+proc each*(�: Range, visit: proc (�0: pointer, �1: CppInt) {.cdecl.}, context: pointer)
+   {.import_cpp: "#.each(@)", header: "callbacks.hpp".}
+proc each*(�: Range, visit: proc (a0: CppInt)) =
+   proc cpp_trampoline(context: pointer, a0: CppInt) {.cdecl.} =
+      cast[ptr proc (a0: CppInt)](context)[](a0)
+   var cpp_closure = visit
+   each(�, cpp_trampoline, addr cpp_closure)
+proc compute_later*(x: CppInt): `std-future`[CppInt]
+   {.import_cpp: "compute_later(@)", header: "callbacks.hpp".}
+proc compute_later_async*(x: CppInt): Future[CppInt] =
+   proc cpp_emplace(held: var Cpp[`std-future`[CppInt]], x: CppInt)
+      {.import_cpp: "#.detail.unsafe_emplace(compute_later(@))", header: "callbacks.hpp".}
+   let op = cpp_future_operation(`std-future`[CppInt], CppInt)
+   cpp_emplace(cpp_held(op), x)
+   result = cpp_poll(op)
+
+#% run
+
+proc main =
+   var seen = 0
+   each(4, proc (i: CppInt) = seen += i)
+   assert(seen == 6)
+   let offset: CppInt = 10
+   assert(sum_mapped(3, proc (i: CppInt): CppInt = i + offset) == 33)
+   assert(wait_for(compute_async(21)) == 42)
+   var visited = 0
+   Range(count: 3).each(proc (i: CppInt) = visited += i + 1)
+   assert(visited == 6)
+   assert(wait_for(compute_later_async(5)) == 15)
+
+main()
@@ -0,0 +1,27 @@
+#include <cstddef>
+
+constexpr std::size_t block_size = 4096;
+constexpr int min_offset = -16;
+constexpr double scale = 0.5;
+constexpr bool enabled = true;
+constexpr const char* greeting = "hello \"world\"\n";
+const unsigned long long all_ones = ~0ull;
+
+typedef int count_t;
+constexpr count_t count = 3;
+
+struct Limits {
+   static constexpr int max_depth = 8;
+};
+
+int counter = 0;
+
+#define BUFFER_SIZE 8192
+#define BUFFER_MASK (BUFFER_SIZE - 1)
+#define FLAG_BITS (1u << 4 | 0x3)
+#define RATIO 0.25f
+#define NAME "ensnare" "_test"
+#define IDENTITY(x) x
+#define NOT_CONSTANT counter
+
+inline auto scaled(int value, int factor = BUFFER_SIZE / 1024 + 1) -> int { return value * factor; }
@@ -0,0 +1,42 @@
+import ensnare/runtime
+export runtime
+
+type
+   count_t* = CppInt
+   Limits* {.import_cpp: "Limits", header: "consts.hpp", bycopy.} = object
+
+const
+   block_size*: CppSize = 4096
+   min_offset*: CppInt = -16
+   scale*: CppDouble = 0.5
+   enabled*: CppBool = true
+   greeting*: cstring = "hello \"world\"\n"
+   all_ones*: CppULongLong = 18446744073709551615'u64
+   count*: count_t = 3
+   `Limits-max_depth`*: CppInt = 8
+   BUFFER_SIZE* = 8192
+   BUFFER_MASK* = 8191
+   FLAG_BITS* = 19
+   RATIO* = 0.25
+   NAME* = "ensnare_test"
+
+proc scaled*(value: CppInt, factor: CppInt = 9): CppInt
+   {.import_cpp: "scaled(@)", header: "consts.hpp".}
+
+var
+   counter* {.import_cpp: "counter", header: "consts.hpp".}: CppInt
+
+#% run
+
+proc main =
+   var buf: array[int(block_size), byte]
+   assert(buf.len == 4096)
+   assert(`Limits-max_depth` == 8 and min_offset == -16)
+   assert(count == 3)
+   assert($greeting == "hello \"world\"\n")
+   assert(BUFFER_SIZE - 1 == BUFFER_MASK and NAME == "ensnare_test")
+   assert(scaled(2) == 18)
+   counter += 1
+   assert(counter == 1)
+
+main()
@@ -0,0 +1,11 @@
+#include <cstdint>
+
+enum class Level : std::uint8_t { quiet, loud };
+
+enum Perm : unsigned { perm_none = 0, perm_read = 1, perm_write = 2, perm_exec = 4 };
+
+inline auto can_write(Perm perm) -> bool { return (perm & perm_write) != 0; }
+
+inline auto grant(Perm perm = perm_read) -> unsigned { return perm; }
+
+inline auto is_lower(char c = 'a') -> bool { return c >= 'a' && c <= 'z'; }
@@ -0,0 +1,39 @@
+import ensnare/runtime
+export runtime
+
+type
+   Level* {.import_cpp: "Level", header: "enums.hpp", size: 1.} = enum
+      quiet = 0
+      loud = 1
+   Perm* {.import_cpp: "Perm", header: "enums.hpp", size: 4.} = enum
+      perm_none = 0
+      perm_read = 1
+      perm_write = 2
+      perm_exec = 4
+   Perm_flag* {.pure.} = enum
+      perm_read = 0
+      perm_write = 1
+      perm_exec = 2
+   Perm_flags* = set[Perm_flag]
+
+converter to_cpp*(flags: Perm_flags): Perm {.inline.} = cpp_from_flags(flags, Perm)
+proc to_flags*(value: Perm): Perm_flags {.inline.} = cpp_to_flags(value, Perm_flags)
+
+proc can_write*(perm: Perm): CppBool
+   {.import_cpp: "can_write(@)", header: "enums.hpp".}
+proc grant*(perm: Perm = Perm(1)): CppUInt
+   {.import_cpp: "grant(@)", header: "enums.hpp".}
+proc is_lower*(c: CppChar = CppChar(97)): CppBool
+   {.import_cpp: "is_lower(@)", header: "enums.hpp".}
+
+#% run
+
+proc main =
+   assert(size_of(Level) == 1 and size_of(Perm) == 4)
+   assert(can_write({Perm_flag.perm_read, Perm_flag.perm_write}))
+   assert(not can_write({Perm_flag.perm_exec}))
+   assert(Perm.perm_write.to_flags == {Perm_flag.perm_write})
+   assert(grant() == 1 and grant(perm_exec) == 4)
+   assert(is_lower() and not is_lower('A'))
+
+main()
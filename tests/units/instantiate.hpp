@@ -0,0 +1,12 @@
+#include <vector>
+
+template <typename T> struct Box {
+   T value;
+};
+
+template <typename K, typename V> struct Pair {
+   K key;
+   V value;
+
+   auto first() const -> K { return key; }
+};
@@ -0,0 +1,53 @@
+import ensnare/runtime
+export runtime
+from std/os import parent_dir, quote_shell, `/`
+{.pass_c: "-I" & quote_shell(current_source_path().parent_dir).}
+{.compile: "instantiate_instances.cpp".}
+
+type
+   Pair_int_float* {.import_cpp: "Pair<int, float>", header: "instantiate_headers.hpp", bycopy.} = object
+      key: CppInt
+      value: CppFloat
+   Box* [T] {.import_cpp: "Box<'0>", header: "instantiate_headers.hpp".} = object
+      value: T
+   Pair_int_Box_float* {.import_cpp: "Pair<int, Box<float> >", header: "instantiate_headers.hpp", bycopy.} = object
+      key: CppInt
+      value: Box[CppFloat]
+   Pair* [K; V] {.import_cpp: "Pair<'0, '1>", header: "instantiate_headers.hpp".} = object
+      key: K
+      value: V
+
+proc first*(�: Pair_int_float): CppInt
+   {.import_cpp: "#.first(@)", header: "instantiate_headers.hpp".}
+proc first*(�: Pair_int_Box_float): CppInt
+   {.import_cpp: "#.first(@)", header: "instantiate_headers.hpp".}
+proc first*[K; V](�: Pair[K, V]): K
+   {.import_cpp: "#.first(@)", header: "instantiate_headers.hpp".}
+
+#% file instantiate_headers.hpp
+
+#pragma once
+
+#include "instantiate.hpp"
+extern template class Pair<int, float>;
+extern template class Pair<int, Box<float>>;
+
+#% file instantiate_instances.cpp
+
+#include "instantiate_headers.hpp"
+
+template class Pair<int, float>;
+template class Pair<int, Box<float>>;
+
+#% run
+
+proc main =
+   let pair = Pair_int_float(key: 1, value: 2)
+   assert(pair.first == 1)
+   let nested = Pair_int_Box_float(key: 5, value: Box[CppFloat](value: 6))
+   assert(nested.first == 5 and nested.value.value == 6)
+   # Other instantiations still go through the generic.
+   let other = Pair[CppFloat, CppInt](key: 3, value: 4)
+   assert(other.first == 3)
+
+main()
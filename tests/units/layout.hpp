@@ -0,0 +1,31 @@
+struct Point {
+   float x;
+   float y;
+};
+
+struct Segment {
+   Point a;
+   Point b;
+   unsigned char tag;
+};
+
+struct Partial {
+   int visible;
+
+   private:
+   int hidden;
+};
+
+struct alignas(64) Padded {
+   int count;
+};
+
+struct __attribute__((packed)) Wire {
+   unsigned char tag;
+   unsigned int value;
+};
+
+struct Aligned {
+   char c;
+   alignas(16) int x;
+};
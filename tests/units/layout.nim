@@ -0,0 +1,53 @@
+import ensnare/runtime
+export runtime
+
+type
+   Point* {.import_cpp: "Point", header: "layout.hpp", bycopy, complete_struct.} = object
+      x: CppFloat
+      y: CppFloat
+   Segment* {.import_cpp: "Segment", header: "layout.hpp", bycopy, complete_struct.} = object
+      a: Point
+      b: Point
+      tag: CppUChar
+   Partial* {.import_cpp: "Partial", header: "layout.hpp", bycopy.} = object
+      visible: CppInt
+   Padded* {.import_cpp: "Padded", header: "layout.hpp", bycopy, complete_struct.} = object
+      count {.align: 64.}: CppInt
+   Wire* {.import_cpp: "Wire", header: "layout.hpp", bycopy, complete_struct, packed.} = object
+      tag: CppUChar
+      value: CppUInt
+   Aligned* {.import_cpp: "Aligned", header: "layout.hpp", bycopy, complete_struct.} = object
+      c: CppChar
+      x {.align: 16.}: CppInt
+
+when size_of(pointer) == 8:
+   static:
+      assert(size_of(Point) == 8)
+      assert(align_of(Point) == 4)
+      assert(offset_of(Point, x) == 0)
+      assert(offset_of(Point, y) == 4)
+      assert(size_of(Segment) == 20)
+      assert(align_of(Segment) == 4)
+      assert(offset_of(Segment, a) == 0)
+      assert(offset_of(Segment, b) == 8)
+      assert(offset_of(Segment, tag) == 16)
+      assert(size_of(Padded) == 64)
+      assert(align_of(Padded) == 64)
+      assert(offset_of(Padded, count) == 0)
+      assert(size_of(Wire) == 5)
+      assert(align_of(Wire) == 1)
+      assert(offset_of(Wire, tag) == 0)
+      assert(offset_of(Wire, value) == 1)
+      assert(size_of(Aligned) == 32)
+      assert(align_of(Aligned) == 16)
+      assert(offset_of(Aligned, c) == 0)
+      assert(offset_of(Aligned, x) == 16)
+
+#% run
+
+proc main =
+   let s = Segment(a: Point(x: 1, y: 2), b: Point(x: 3, y: 4), tag: 5)
+   assert(s.b.y == 4 and s.tag == 5)
+   let w = Wire(tag: 1, value: 0xdeadbeef'u32)
+   assert(w.value == 0xdeadbeef'u32)
+main()
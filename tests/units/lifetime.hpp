@@ -0,0 +1,40 @@
+inline int tracked_live = 0;
+inline int tracked_destroyed = 0;
+
+// Counts its objects, so tests can see every construction and destruction.
+class Tracked {
+   int value;
+
+   public:
+   Tracked(int value) : value(value) { tracked_live += 1; }
+
+   Tracked(Tracked&& other) : value(other.value) {
+      other.value = 0;
+      tracked_live += 1;
+   }
+
+   Tracked(const Tracked& other) : value(other.value) { tracked_live += 1; }
+
+   ~Tracked() {
+      tracked_live -= 1;
+      tracked_destroyed += 1;
+   }
+
+   auto get() const -> int { return value; }
+};
+
+// Can only be moved, like `std::unique_ptr`.
+class Unique {
+   int* value;
+
+   public:
+   Unique(int value) : value(new int(value)) {}
+
+   Unique(const Unique&) = delete;
+
+   Unique(Unique&& other) : value(other.value) { other.value = nullptr; }
+
+   ~Unique() { delete value; }
+
+   auto get() const -> int { return *value; }
+};
@@ -0,0 +1,69 @@
+import ensnare/runtime
+export runtime
+
+type
+   Tracked* {.import_cpp: "Tracked", header: "lifetime.hpp".} = object
+   Unique* {.import_cpp: "Unique", header: "lifetime.hpp".} = object
+
+proc cpp_destroy*(self: var Cpp[Tracked])
+   {.import_cpp: "#.detail.unsafe_destroy()", header: "lifetime.hpp".}
+proc cpp_copy*(dst: var Cpp[Tracked], src: Cpp[Tracked])
+   {.import_cpp: "#.detail.unsafe_copy_assign(#.detail)", header: "lifetime.hpp".}
+proc cpp_sink*(dst: var Cpp[Tracked], src: Cpp[Tracked])
+   {.import_cpp: "#.detail.unsafe_move(#.detail)", header: "lifetime.hpp".}
+proc `{}`*(�: type[Tracked], value: CppInt): Tracked
+   {.import_cpp: "'0(@)", header: "lifetime.hpp".}
+proc `{}`*(�: type[Tracked], other: sink Tracked): Tracked
+   {.import_cpp: "#'0(static_cast<'2&&>(#))", header: "lifetime.hpp".}
+proc get*(�: Tracked): CppInt
+   {.import_cpp: "#.get(@)", header: "lifetime.hpp".}
+proc cpp_destroy*(self: var Cpp[Unique])
+   {.import_cpp: "#.detail.unsafe_destroy()", header: "lifetime.hpp".}
+proc `=`*(dst: var Cpp[Unique], src: Cpp[Unique])
+   {.error: "Unique is not copyable".}
+proc cpp_sink*(dst: var Cpp[Unique], src: Cpp[Unique])
+   {.import_cpp: "#.detail.unsafe_move(#.detail)", header: "lifetime.hpp".}
+proc `{}`*(�: type[Unique], value: CppInt): Unique
+   {.import_cpp: "'0(@)", header: "lifetime.hpp".}
+proc `{}`*(�: type[Unique], other: sink Unique): Unique
+   {.import_cpp: "#'0(static_cast<'2&&>(#))", header: "lifetime.hpp".}
+proc get*(�: Unique): CppInt
+   {.import_cpp: "#.get(@)", header: "lifetime.hpp".}
+
+var
+   tracked_live* {.import_cpp: "tracked_live", header: "lifetime.hpp".}: CppInt
+   tracked_destroyed* {.import_cpp: "tracked_destroyed", header: "lifetime.hpp".}: CppInt
+
+#% run
+
+proc main =
+   block:
+      var a = Cpp[Tracked]{1}
+      assert(tracked_live == 1 and tracked_destroyed == 0)
+      # The live object is destroyed before the new one is constructed in its place.
+      a.emplace(2)
+      assert(a.deref.get == 2)
+      assert(tracked_live == 1 and tracked_destroyed == 1)
+      # Moving into a new, dead slot destroys the moved from object and leaves `a` dead.
+      var b = cpp_move(a)
+      assert(b.deref.get == 2)
+      assert(tracked_live == 1 and tracked_destroyed == 2)
+      a.emplace(4)
+      assert(a.deref.get == 4)
+      assert(tracked_live == 2 and tracked_destroyed == 2)
+      # Moving into a live slot destroys its object first.
+      var c = Cpp[Tracked]{3}
+      c = cpp_move(b)
+      assert(c.deref.get == 2)
+      assert(tracked_live == 2 and tracked_destroyed == 5)
+   # `b` was dead, only `a` and `c` are left to destroy.
+   assert(tracked_live == 0 and tracked_destroyed == 7)
+   # A move only class can still be held and moved, only copying it is an error.
+   var u = Cpp[Unique]{5}
+   var w = cpp_move(u)
+   assert(w.deref.get == 5)
+   u = cpp_move(w)
+   assert(u.deref.get == 5)
+   assert(not compiles(w = u))
+
+main()
@@ -0,0 +1,4 @@
+#include <string>
+
+// Standard headers are what precompiling saves the most time on.
+inline auto greet(int times) -> int { return std::string(times, '!').size(); }
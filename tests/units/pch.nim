@@ -0,0 +1,22 @@
+import ensnare/runtime
+export runtime
+from std/os import parent_dir, quote_shell, `/`
+{.pass_c: "-I" & quote_shell(current_source_path().parent_dir).}
+when cpp_pch_usable(current_source_path().parent_dir / "pch_headers.hpp.pch"):
+   {.pass_c: "-include-pch " & quote_shell(current_source_path().parent_dir / "pch_headers.hpp.pch").}
+
+proc greet*(times: CppInt): CppInt
+   {.import_cpp: "greet(@)", header: "pch_headers.hpp".}
+
+#% file pch_headers.hpp
+
+#pragma once
+
+#include "pch.hpp"
+
+#% run
+
+proc main =
+   assert(greet(3) == 3)
+
+main()
@@ -3,21 +3,31 @@ export runtime
 
 type
    lexbor_mem_chunk_t* = lexbor_mem_chunk
-   lexbor_mem_chunk* {.import_cpp: "lexbor_mem_chunk", header: "redecls2.hpp".} = object
+   lexbor_mem_chunk* {.import_cpp: "lexbor_mem_chunk", header: "redecls2.hpp", bycopy, complete_struct.} = object
       next: ptr lexbor_mem_chunk_t
-   lexbor_mem* {.import_cpp: "lexbor_mem", header: "redecls2.hpp".} = object
+   lexbor_mem* {.import_cpp: "lexbor_mem", header: "redecls2.hpp", bycopy, complete_struct.} = object
       chunk: ptr lexbor_mem_chunk_t
    lexbor_mem_t* = lexbor_mem
    foo_t* = foo
-   foo* {.import_cpp: "foo", header: "redecls.hpp".} = object
+   foo* {.import_cpp: "foo", header: "redecls.hpp", bycopy, complete_struct.} = object
       base: ptr foo_t
 
+when size_of(pointer) == 8:
+   static:
+      assert(size_of(lexbor_mem_chunk) == 8)
+      assert(align_of(lexbor_mem_chunk) == 8)
+      assert(offset_of(lexbor_mem_chunk, next) == 0)
+      assert(size_of(lexbor_mem) == 8)
+      assert(align_of(lexbor_mem) == 8)
+      assert(offset_of(lexbor_mem, chunk) == 0)
+      assert(size_of(foo) == 8)
+      assert(align_of(foo) == 8)
+      assert(offset_of(foo, base) == 0)
+
 proc `{}`*(�: type[lexbor_mem_chunk]): lexbor_mem_chunk
-   {.import_cpp: "'0(@)", header: "redecls2.hpp".}
-proc `{}`*(�: type[lexbor_mem_chunk], �1: var CppConst[lexbor_mem_chunk]): lexbor_mem_chunk
-   {.import_cpp: "'0(@)", header: "redecls2.hpp".}
-proc `{}`*(�: type[lexbor_mem_chunk], �1: lexbor_mem_chunk): lexbor_mem_chunk
-   {.import_cpp: "'0(@)", header: "redecls2.hpp".}
+   {.import_cpp: "'0(@)", header: "redecls2.hpp", raises: [].}
+proc `{}`*(�: type[lexbor_mem_chunk], �1: sink lexbor_mem_chunk): lexbor_mem_chunk
+   {.import_cpp: "#'0(static_cast<'2&&>(#))", header: "redecls2.hpp", raises: [].}
 
 var
    type_map* {.import_cpp: "type_map", header: "redecls.hpp".}: lexbor_mem_chunk_t
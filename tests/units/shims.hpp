@@ -0,0 +1,21 @@
+struct Point {
+   float x;
+   float y;
+
+   // Methods take their object through a pointer.
+   auto dot(const Point& other) const -> float { return x * other.x + y * other.y; }
+
+   void translate(float dx, float dy) {
+      x += dx;
+      y += dy;
+   }
+};
+
+inline auto scale(float by, int times) -> float { return by * times; }
+
+inline void bump(int& counter) { counter += 1; }
+
+// Plain structs cross the thunks by value.
+inline auto midpoint(Point a, Point b) -> Point { return {(a.x + b.x) / 2, (a.y + b.y) / 2}; }
+
+inline auto length_squared(const Point& p) -> float { return p.dot(p); }
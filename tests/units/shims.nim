@@ -0,0 +1,74 @@
+import ensnare/runtime
+export runtime
+{.compile: "shims_shims.cpp".}
+
+type
+   Point* {.bycopy.} = object
+      x: CppFloat
+      y: CppFloat
+
+when size_of(pointer) == 8:
+   static:
+      assert(size_of(Point) == 8)
+      assert(align_of(Point) == 4)
+      assert(offset_of(Point, x) == 0)
+      assert(offset_of(Point, y) == 4)
+
+proc dot*(� {.byref.}: Point, other {.byref.}: Point): CppFloat
+   {.import_c: "ensnare_shims_shim_0", cdecl.}
+proc translate*(�: var Point, dx: CppFloat, dy: CppFloat)
+   {.import_c: "ensnare_shims_shim_1", cdecl.}
+proc scale*(by: CppFloat, times: CppInt): CppFloat
+   {.import_c: "ensnare_shims_shim_2", cdecl.}
+proc bump*(counter: var CppInt)
+   {.import_c: "ensnare_shims_shim_3", cdecl.}
+proc midpoint*(a: Point, b: Point): Point
+   {.import_c: "ensnare_shims_shim_4", cdecl.}
+proc length_squared*(p {.byref.}: Point): CppFloat
+   {.import_c: "ensnare_shims_shim_5", cdecl.}
+
+#% file shims_shims.cpp
+
+#include "shims.hpp"
+
+extern "C" {
+
+float ensnare_shims_shim_0(const Point* self, const Point* a0) {
+   return self->dot(*a0);
+}
+
+void ensnare_shims_shim_1(Point* self, float a0, float a1) {
+   self->translate(a0, a1);
+}
+
+float ensnare_shims_shim_2(float a0, int a1) {
+   return scale(a0, a1);
+}
+
+void ensnare_shims_shim_3(int* a0) {
+   bump(*a0);
+}
+
+Point ensnare_shims_shim_4(Point a0, Point a1) {
+   return midpoint(a0, a1);
+}
+
+float ensnare_shims_shim_5(const Point* a0) {
+   return length_squared(*a0);
+}
+}
+
+#% run
+
+proc main =
+   assert(scale(1.5, 2) == 3)
+   var counter: CppInt = 1
+   bump(counter)
+   assert(counter == 2)
+   var mid = midpoint(Point(x: 0, y: 2), Point(x: 4, y: 6))
+   assert(mid.x == 2 and mid.y == 4)
+   mid.translate(1, -1)
+   assert(mid.dot(Point(x: 1, y: 1)) == 6)
+   assert(length_squared(mid) == 18)
+
+main()
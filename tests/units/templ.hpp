@@ -23,4 +23,16 @@ template <std::size_t size, typename T> class Vec {
    T& operator[](std::size_t i) { return data[i]; }
 
    template <typename U> static int double_size(U val) { return size * 2; }
+
+   // `U` cannot be inferred from the arguments, so nim callers have to pass it.
+   template <typename U> U first_as() { return U(data[0]); }
+};
+
+// Zero sized arrays are not allowed, so an empty mask keeps a single bit.
+template <std::size_t size> struct Mask {
+   bool bits[size + !size];
+};
+
+struct Quad {
+   Vec<2 * 2, float> corners;
 };
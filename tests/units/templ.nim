@@ -4,25 +4,27 @@ export runtime
 type
    Vec* [size: static[CppSize]; T] {.import_cpp: "Vec<'0, '1>", header: "templ.hpp".} = object
       data: array[size, T]
+   Mask* [size: static[CppSize]] {.import_cpp: "Mask<'0>", header: "templ.hpp".} = object
+      bits: array[(size + CppSize((not (size != 0)))), CppBool]
+   Quad* {.import_cpp: "Quad", header: "templ.hpp", bycopy.} = object
+      corners: Vec[4, CppFloat]
 
-proc foo_internal[T](a: T, b: T, �3: type[T]): T
-   {.import_cpp: "foo<'3>(@)", header: "templ.hpp".}
-proc foo*[T](a: T, b: T): T =
-   foo_internal(a, b, T)
+proc foo*[T](a: T, b: T): T
+   {.import_cpp: "foo(@)", header: "templ.hpp".}
 proc `{}`*[size: static[CppSize]; T](�: type[Vec[size, T]], val: T): Vec[size, T]
    {.import_cpp: "'0(@)", header: "templ.hpp".}
 proc `{}`*[size: static[CppSize]; T; U](�: type[Vec[size, T]], val: T, nop_val: U): Vec[size, T]
    {.import_cpp: "'0(@)", header: "templ.hpp".}
-proc nop_internal[size: static[CppSize]; T; U](�: Vec[size, T], val: Vec[size, U], �2: type[U])
-   {.import_cpp: "#.nop<'3>(@)", header: "templ.hpp".}
-proc nop*[size: static[CppSize]; T; U](�: Vec[size, T], val: Vec[size, U]) =
-   nop_internal(�, val, U)
+proc nop*[size: static[CppSize]; T; U](�: Vec[size, T], val: Vec[size, U])
+   {.import_cpp: "#.nop(@)", header: "templ.hpp".}
 proc `[]`*[size: static[CppSize]; T](�: Vec[size, T], i: CppSize): var T
    {.import_cpp: "#.operator[](@)", header: "templ.hpp".}
-proc double_size_internal[size: static[CppSize]; T; U](�: type[Vec[size, T]], val: U, �1: type[U]): CppInt
-   {.import_cpp: "'0::double_size(@)", header: "templ.hpp".}
-proc double_size*[size: static[CppSize]; T; U](�: type[Vec[size, T]], val: U): CppInt =
-   double_size_internal(�, U)
+proc double_size*[size: static[CppSize]; T; U](�: type[Vec[size, T]], val: U): CppInt
+   {.import_cpp: "'1::double_size(@)", header: "templ.hpp".}
+proc first_as_internal[size: static[CppSize]; T; U](�: Vec[size, T], �2: type[U]): U
+   {.import_cpp: "#.first_as<'2>(@)", header: "templ.hpp".}
+template first_as*[size: static[CppSize]; T; U](�: Vec[size, T]): U =
+   first_as_internal(�, U)
 
 #% run
 
@@ -41,7 +43,8 @@ proc main =
    x.nop(y)
    assert($x == "[1, 1, 1, 1]")
    assert($y == "[2.0, 2.0, 2.0, 2.0]")
-   assert(x.we_need_a_method_template_test_too[:x.size, x.T, int]() == 1)
-   assert(Vec[8.CppSize, uint8].double_size == 16)
+   assert(x.first_as[:4.CppSize, int, float]() == 1.0)
+   assert(Vec[8.CppSize, uint8].double_size(0) == 16)
+   assert(size_of(Mask[0.CppSize]) == 1 and size_of(Mask[2.CppSize]) == 2)
 
 main()
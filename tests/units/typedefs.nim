@@ -2,7 +2,7 @@ import ensnare/runtime
 export runtime
 
 type
-   TypedefNameName* {.import_cpp: "TypedefNameName", header: "typedefs.hpp".} = object
-   TypedefNameAlias* {.import_cpp: "TypedefNameAlias", header: "typedefs.hpp".} = object
+   TypedefNameName* {.import_cpp: "TypedefNameName", header: "typedefs.hpp", bycopy.} = object
+   TypedefNameAlias* {.import_cpp: "TypedefNameAlias", header: "typedefs.hpp", bycopy.} = object
    TypedefNameAliasAlias* = TypedefNameAlias
-   TypedefAnonName* {.import_cpp: "TypedefAnonName", header: "typedefs.hpp".} = object
+   TypedefAnonName* {.import_cpp: "TypedefAnonName", header: "typedefs.hpp", bycopy.} = object
@@ -0,0 +1,7 @@
+struct Counter {
+   int count;
+
+   void add(int n) { count += n; }
+};
+
+inline auto twice(int x) -> int { return x * 2; }
@@ -0,0 +1,35 @@
+import ensnare/runtime
+export runtime
+from std/os import parent_dir, quote_shell, `/`
+{.pass_c: "-I" & quote_shell(current_source_path().parent_dir).}
+
+type
+   Counter* {.import_cpp: "Counter", header: "umbrella_headers.hpp", bycopy, complete_struct.} = object
+      count: CppInt
+
+when size_of(pointer) == 8:
+   static:
+      assert(size_of(Counter) == 4)
+      assert(align_of(Counter) == 4)
+      assert(offset_of(Counter, count) == 0)
+
+proc add*(�: Counter, n: CppInt)
+   {.import_cpp: "#.add(@)", header: "umbrella_headers.hpp".}
+proc twice*(x: CppInt): CppInt
+   {.import_cpp: "twice(@)", header: "umbrella_headers.hpp".}
+
+#% file umbrella_headers.hpp
+
+#pragma once
+
+#include "umbrella.hpp"
+
+#% run
+
+proc main =
+   var counter = Counter(count: 1)
+   counter.add(2)
+   assert(counter.count == 3)
+   assert(twice(4) == 8)
+
+main()
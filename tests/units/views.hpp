@@ -0,0 +1,57 @@
+#include <cstddef>
+
+class Samples {
+   float values[4] = {0, 0, 0, 0};
+
+   public:
+   float* data() { return values; }
+   std::size_t size() const { return 4; }
+};
+
+class Text {
+   const char* chars;
+   std::size_t length;
+
+   public:
+   Text(const char* chars, std::size_t length) : chars(chars), length(length) {}
+   const char* data() const { return chars; }
+   std::size_t size() const { return length; }
+};
+
+class Bag {
+   int slots[3] = {0, 0, 0};
+
+   public:
+   int* begin() { return slots; }
+   int* end() { return slots + 3; }
+};
+
+class Ring {
+   int slots[2] = {0, 0};
+
+   public:
+   // Like most iterators, its `operator*` is not const.
+   class iterator {
+      int* at;
+
+      public:
+      iterator(int* at) : at(at) {}
+      int& operator*() { return *at; }
+      iterator& operator++() {
+         at += 1;
+         return *this;
+      }
+      bool operator!=(const iterator& other) const { return at != other.at; }
+   };
+
+   iterator begin() { return iterator(slots); }
+   iterator end() { return iterator(slots + 2); }
+};
+
+inline auto count(Text text, char c) -> int {
+   auto result = 0;
+   for (std::size_t i = 0; i < text.size(); i += 1) {
+      result += text.data()[i] == c;
+   }
+   return result;
+}
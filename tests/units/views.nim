@@ -0,0 +1,91 @@
+import ensnare/runtime
+export runtime
+
+type
+   Samples* {.import_cpp: "Samples", header: "views.hpp", bycopy.} = object
+   Text* {.import_cpp: "Text", header: "views.hpp", bycopy.} = object
+   Bag* {.import_cpp: "Bag", header: "views.hpp", bycopy.} = object
+   Ring* {.import_cpp: "Ring", header: "views.hpp", bycopy.} = object
+   `Ring-iterator`* {.import_cpp: "Ring::iterator", header: "views.hpp", bycopy.} = object
+
+proc data*(�: Samples): ptr CppFloat
+   {.import_cpp: "#.data(@)", header: "views.hpp".}
+proc size*(�: Samples): CppSize
+   {.import_cpp: "#.size(@)", header: "views.hpp".}
+template to_open_array*(self: Samples): untyped =
+   cpp_open_array(self, CppFloat)
+proc `{}`*(�: type[Text], chars: ptr CppConst[CppChar], length: CppSize): Text
+   {.import_cpp: "'0(@)", header: "views.hpp".}
+proc data*(�: Text): ptr CppConst[CppChar]
+   {.import_cpp: "#.data(@)", header: "views.hpp".}
+proc size*(�: Text): CppSize
+   {.import_cpp: "#.size(@)", header: "views.hpp".}
+template to_open_array*(self: Text): untyped =
+   cpp_open_array(self, CppChar)
+proc from_open_array*(�: type[Text], elements: openArray[CppChar]): Text
+   {.import_cpp: "'0(@)", header: "views.hpp".}
+proc begin*(�: Bag): ptr CppInt
+   {.import_cpp: "#.begin(@)", header: "views.hpp".}
+proc `end`*(�: Bag): ptr CppInt
+   {.import_cpp: "#.end(@)", header: "views.hpp".}
+iterator items*(self: Bag): lent CppInt =
+   cpp_iterate(self, ptr CppInt, it):
+      yield cpp_deref(it, CppInt)
+iterator mitems*(self: var Bag): var CppInt =
+   cpp_iterate(self, ptr CppInt, it):
+      yield cpp_deref(it, CppInt)
+iterator pairs*(self: Bag): tuple[key: int, val: CppInt] =
+   var i = 0
+   cpp_iterate(self, ptr CppInt, it):
+      yield (i, cpp_deref(it, CppInt))
+      i += 1
+proc begin*(�: Ring): `Ring-iterator`
+   {.import_cpp: "#.begin(@)", header: "views.hpp".}
+proc `end`*(�: Ring): `Ring-iterator`
+   {.import_cpp: "#.end(@)", header: "views.hpp".}
+iterator items*(self: Ring): lent CppInt =
+   cpp_iterate(self, `Ring-iterator`, it):
+      yield cpp_deref(it, CppInt)
+iterator mitems*(self: var Ring): var CppInt =
+   cpp_iterate(self, `Ring-iterator`, it):
+      yield cpp_deref(it, CppInt)
+iterator pairs*(self: Ring): tuple[key: int, val: CppInt] =
+   var i = 0
+   cpp_iterate(self, `Ring-iterator`, it):
+      yield (i, cpp_deref(it, CppInt))
+      i += 1
+proc count*(text: Text, c: CppChar): CppInt
+   {.import_cpp: "count(@)", header: "views.hpp".}
+
+#% run
+
+proc total(values: openArray[CppFloat]): CppFloat =
+   for value in values:
+      result += value
+
+proc main =
+   var samples: Samples
+   let values = cast[ptr UncheckedArray[CppFloat]](samples.data)
+   for i in 0 ..< 4:
+      values[i] = CppFloat(i + 1)
+   assert(total(samples.to_open_array) == 10)
+   let text = Text.from_open_array("a banana")
+   assert(text.to_open_array.len == 8 and count(text, 'a') == 4)
+   var bag: Bag
+   for slot in bag.mitems:
+      slot = 2
+   var sum, weighted = 0
+   for slot in bag:
+      sum += slot
+   for i, slot in bag:
+      weighted += i * slot
+   assert(sum == 6 and weighted == 6)
+   var ring: Ring
+   for slot in ring.mitems:
+      slot = 3
+   var ring_sum = 0
+   for slot in ring:
+      ring_sum += slot
+   assert(ring_sum == 6)
+
+main()